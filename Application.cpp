@@ -46,6 +46,9 @@ namespace ClassGame {
 
 
         if (ImGui::Button("Reset Game")) {
+            // the old game may still be thinking, a ponder search would otherwise run for the rest of the process
+            game->stopGame();
+            delete game;
             game = new Chess(); // Initialize a new Tic Tac Toe game
             game->setUpBoard(); // Set up the game board
             game->setAIPlayer(1); // Set AI as player 2
@@ -54,6 +57,20 @@ namespace ClassGame {
             // game->pauseGame(false); 
         }
 
+        // switch between the parallel searches to compare how they scale
+        int searchMode = game->getAISearchMode();
+        const char *searchModes[] = { "Serial", "Lazy SMP", "Young Brothers Wait" };
+        if (ImGui::Combo("AI Search", &searchMode, searchModes, IM_ARRAYSIZE(searchModes))) {
+            game->setAISearchMode(searchMode);
+        }
+        const std::vector<ThreadStats> &stats = game->searchStats();
+        for (size_t i = 0; i < stats.size(); i++) {
+            ImGui::Text("Thread %d: %llu nodes, %llu splits, %llu helped, %llu tasks, %llu steals", (int)i,
+                        (unsigned long long)stats[i].nodes, (unsigned long long)stats[i].splits,
+                        (unsigned long long)stats[i].helpedMoves, (unsigned long long)stats[i].tasks,
+                        (unsigned long long)stats[i].steals);
+        }
+
         ImGui::End();
 
         if (game->gameHasAI() && game->getCurrentPlayer()->isAIPlayer()) {
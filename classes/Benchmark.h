@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Engine.h"
+#include <cstdint>
+#include <functional>
+
+struct BenchmarkResult
+{
+    uint64_t nodes = 0;
+    int64_t elapsedMs = 0;
+};
+
+//
+// A fixed search workload for measuring the engine. Every built-in position is searched to the same depth
+// from a cleared engine, so with one thread the total node count depends only on the engine's code,
+// a signature that changes exactly when the search does, and nodes per second measure its speed.
+//
+namespace Benchmark {
+    extern const char *const positions[];
+    extern const int positionCount;
+
+    // onPosition is called after each position with its index and result
+    BenchmarkResult run(Engine &engine, int depth, const std::function<void(int, const SearchResult &)> &onPosition = nullptr);
+}
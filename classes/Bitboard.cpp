@@ -0,0 +1,163 @@
+#include "Bitboard.h"
+#include <mutex>
+
+Bitboard Bitboards::knightTable[64];
+Bitboard Bitboards::kingTable[64];
+Bitboard Bitboards::pawnTable[2][64];
+
+Bitboards::Magic Bitboards::bishopMagics[64];
+Bitboards::Magic Bitboards::rookMagics[64];
+Bitboard Bitboards::betweenTable[64][64];
+Bitboard Bitboards::lineTable[64][64];
+static Bitboard bishopTable[0x1480];
+static Bitboard rookTable[0x19000];
+
+static const int bishopDirections[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+static const int rookDirections[4][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+
+std::string squareNotation(int square)
+{
+    if (square < 0 || square > 63) {
+        return "-";
+    }
+    return std::string(1, 'a' + squareColumn(square)) + std::string(1, '1' + squareRow(square));
+}
+
+int notationSquare(const std::string &notation)
+{
+    if (notation.size() < 2 || notation[0] < 'a' || notation[0] > 'h' || notation[1] < '1' || notation[1] > '8') {
+        return NoSquare;
+    }
+    return makeSquare(notation[1] - '1', notation[0] - 'a');
+}
+
+// the bit for row/column if it is on the board, otherwise nothing
+static Bitboard bitIfOnBoard(int row, int column)
+{
+    if (row < 0 || row > 7 || column < 0 || column > 7) {
+        return 0;
+    }
+    return squareBit(makeSquare(row, column));
+}
+
+// walk each direction until we leave the board or hit an occupied square (which is included)
+static Bitboard slidingAttacks(int square, Bitboard occupied, const int directions[4][2])
+{
+    Bitboard attacks = 0;
+    for (int i = 0; i < 4; i++) {
+        int row = squareRow(square) + directions[i][0];
+        int column = squareColumn(square) + directions[i][1];
+        while (row >= 0 && row < 8 && column >= 0 && column < 8) {
+            Bitboard bit = squareBit(makeSquare(row, column));
+            attacks |= bit;
+            if (occupied & bit) {
+                break;
+            }
+            row += directions[i][0];
+            column += directions[i][1];
+        }
+    }
+    return attacks;
+}
+
+// xorshift64*, seeded so the magics (and so the table layout) are the same every run
+static Bitboard nextRandom(Bitboard &state)
+{
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 2685821657736338717ULL;
+}
+
+static void buildMagics(Bitboards::Magic magics[64], Bitboard *table, const int directions[4][2])
+{
+    Bitboard occupancies[4096];
+    Bitboard references[4096];
+    int epoch[4096] = {};
+    int attempt = 0;
+    // every square starts over from its row's seed, these find all the magics within a few thousand tries
+    static const Bitboard rowSeeds[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+
+    for (int square = 0; square < 64; square++) {
+        Bitboards::Magic &m = magics[square];
+        Bitboard seed = rowSeeds[squareRow(square)];
+        // the board edge never blocks anything, so leave it out of the mask unless the slider is on it
+        Bitboard edges = ((row1Bits | row8Bits) & ~(row1Bits << (8 * squareRow(square))))
+                       | ((fileABits | fileHBits) & ~(fileABits << squareColumn(square)));
+        m.mask = slidingAttacks(square, 0, directions) & ~edges;
+        m.shift = 64 - popCount(m.mask);
+        m.attacks = square == 0 ? table : magics[square - 1].attacks + (1 << (64 - magics[square - 1].shift));
+
+        // walk every subset of the mask (carry-rippler) and remember its attacks
+        int size = 0;
+        Bitboard blockers = 0;
+        do {
+            occupancies[size] = blockers;
+            references[size] = slidingAttacks(square, blockers, directions);
+            size++;
+            blockers = (blockers - m.mask) & m.mask;
+        } while (blockers);
+
+        // try sparse random numbers until one maps every subset without a harmful collision
+        for (int i = 0; i < size; ) {
+            do {
+                m.magic = nextRandom(seed) & nextRandom(seed) & nextRandom(seed);
+            } while (popCount((m.mask * m.magic) >> 56) < 6);
+
+            attempt++;
+            for (i = 0; i < size; i++) {
+                unsigned index = m.index(occupancies[i]);
+                if (epoch[index] < attempt) {
+                    epoch[index] = attempt;
+                    m.attacks[index] = references[i];
+                } else if (m.attacks[index] != references[i]) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static void buildTables()
+{
+    static const int knightSteps[8][2] = {{2, 1}, {1, 2}, {-1, 2}, {-2, 1}, {-2, -1}, {-1, -2}, {1, -2}, {2, -1}};
+    static const int kingSteps[8][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+    for (int square = 0; square < 64; square++) {
+        int row = squareRow(square);
+        int column = squareColumn(square);
+        Bitboards::knightTable[square] = 0;
+        Bitboards::kingTable[square] = 0;
+        for (int i = 0; i < 8; i++) {
+            Bitboards::knightTable[square] |= bitIfOnBoard(row + knightSteps[i][0], column + knightSteps[i][1]);
+            Bitboards::kingTable[square] |= bitIfOnBoard(row + kingSteps[i][0], column + kingSteps[i][1]);
+        }
+        Bitboards::pawnTable[0][square] = bitIfOnBoard(row + 1, column - 1) | bitIfOnBoard(row + 1, column + 1);
+        Bitboards::pawnTable[1][square] = bitIfOnBoard(row - 1, column - 1) | bitIfOnBoard(row - 1, column + 1);
+    }
+    buildMagics(Bitboards::bishopMagics, bishopTable, bishopDirections);
+    buildMagics(Bitboards::rookMagics, rookTable, rookDirections);
+
+    for (int from = 0; from < 64; from++) {
+        for (int to = 0; to < 64; to++) {
+            Bitboards::betweenTable[from][to] = 0;
+            Bitboards::lineTable[from][to] = 0;
+            if (from == to) {
+                continue;
+            }
+            for (int i = 0; i < 2; i++) {
+                const int (*directions)[2] = i == 0 ? bishopDirections : rookDirections;
+                if (slidingAttacks(from, 0, directions) & squareBit(to)) {
+                    Bitboards::lineTable[from][to] = (slidingAttacks(from, 0, directions) & slidingAttacks(to, 0, directions)) | squareBit(from) | squareBit(to);
+                    Bitboards::betweenTable[from][to] = slidingAttacks(from, squareBit(to), directions) & slidingAttacks(to, squareBit(from), directions);
+                }
+            }
+        }
+    }
+}
+
+void Bitboards::init()
+{
+    static std::once_flag once;
+    std::call_once(once, buildTables);
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <string>
+
+//
+// a bitboard holds one bit per square of the board
+// squares are numbered the same way ChessSquare::getSquareIndex() does them: row * 8 + column, so a1 = 0 and h8 = 63
+//
+typedef uint64_t Bitboard;
+
+enum BoardSquare {
+    A1, B1, C1, D1, E1, F1, G1, H1,
+    A2, B2, C2, D2, E2, F2, G2, H2,
+    A3, B3, C3, D3, E3, F3, G3, H3,
+    A4, B4, C4, D4, E4, F4, G4, H4,
+    A5, B5, C5, D5, E5, F5, G5, H5,
+    A6, B6, C6, D6, E6, F6, G6, H6,
+    A7, B7, C7, D7, E7, F7, G7, H7,
+    A8, B8, C8, D8, E8, F8, G8, H8,
+    NoSquare = 64
+};
+
+enum ChessPiece{
+    NoPiece,
+    Pawn = 1,
+    Knight,
+    Bishop,
+    Rook,
+    Queen,
+    King
+};
+
+// same numbering as the player numbers, 0 is white
+enum ChessColor {
+    White,
+    Black
+};
+
+inline ChessColor oppositeColor(ChessColor color) { return color == White ? Black : White; }
+
+const Bitboard fileABits = 0x0101010101010101ULL;
+const Bitboard fileHBits = fileABits << 7;
+const Bitboard row1Bits = 0xFFULL;
+const Bitboard row8Bits = row1Bits << 56;
+
+inline Bitboard squareBit(int square) { return 1ULL << square; }
+inline int squareRow(int square) { return square >> 3; }
+inline int squareColumn(int square) { return square & 7; }
+inline int makeSquare(int row, int column) { return row * 8 + column; }
+
+inline int popCount(Bitboard bits) { return std::popcount(bits); }
+// index of the lowest set bit, bits must not be empty
+inline int lsb(Bitboard bits) { return std::countr_zero(bits); }
+inline int popLsb(Bitboard &bits)
+{
+    int square = lsb(bits);
+    bits &= bits - 1;
+    return square;
+}
+
+// "e4" style notation, the same the ChessSquares use
+std::string squareNotation(int square);
+int notationSquare(const std::string &notation);
+
+namespace Bitboards {
+    // builds the attack tables, safe to call more than once
+    void init();
+
+    extern Bitboard knightTable[64];
+    extern Bitboard kingTable[64];
+    extern Bitboard pawnTable[2][64];
+
+    inline Bitboard knightAttacks(int square) { return knightTable[square]; }
+    inline Bitboard kingAttacks(int square) { return kingTable[square]; }
+    // squares attacked by a pawn of the given color (0 white, 1 black) standing on square
+    inline Bitboard pawnAttacks(int color, int square) { return pawnTable[color][square]; }
+
+    //
+    // magic bitboards: the blockers that matter to a slider are multiplied by a magic number so the top bits
+    // become a perfect index into that square's slice of the attack table
+    //
+    struct Magic
+    {
+        Bitboard mask;
+        Bitboard magic;
+        Bitboard *attacks;
+        int shift;
+
+        unsigned index(Bitboard occupied) const { return (unsigned)(((occupied & mask) * magic) >> shift); }
+    };
+
+    extern Magic bishopMagics[64];
+    extern Magic rookMagics[64];
+
+    inline Bitboard bishopAttacks(int square, Bitboard occupied)
+    {
+        const Magic &m = bishopMagics[square];
+        return m.attacks[m.index(occupied)];
+    }
+    inline Bitboard rookAttacks(int square, Bitboard occupied)
+    {
+        const Magic &m = rookMagics[square];
+        return m.attacks[m.index(occupied)];
+    }
+    inline Bitboard queenAttacks(int square, Bitboard occupied)
+    {
+        return bishopAttacks(square, occupied) | rookAttacks(square, occupied);
+    }
+
+    extern Bitboard betweenTable[64][64];
+    extern Bitboard lineTable[64][64];
+
+    // squares strictly between two squares on the same row, column or diagonal, empty otherwise
+    inline Bitboard betweenBits(int from, int to) { return betweenTable[from][to]; }
+    // the whole row, column or diagonal through both squares, empty if they don't share one
+    inline Bitboard lineBits(int from, int to) { return lineTable[from][to]; }
+}
@@ -4,6 +4,7 @@ Chess::Chess() {
 }
 
 Chess::~Chess() {
+    stopAISearch();
 }
 
 std::string Chess::pieceNotation(int row, int column) const
@@ -24,37 +25,35 @@ std::string Chess::pieceNotation(int row, int column) const
 }
 
 void Chess::FENtoBoard(const std::string &fen) {
-    std::istringstream fenStream(fen);
-    std::string placement;
-    getline(fenStream, placement, ' ');
-
-    int row = 7; // Start from the top of the board, which corresponds to row 7 in a 0-indexed array
-    int col = 0;
-    for (char ch : placement) {
-        if (ch == '/') {
-            row--; // Move to the next row down
-            col = 0; // Reset column to the start of the row
-            continue;
-        }
-
-        if (isdigit(ch)) {
-            col += ch - '0'; // Skip empty squares as indicated by the digit
-        } else {
-            int playerNumber = isupper(ch) ? 0 : 1; // Determine player based on case
-            ChessPiece piece = charToChessPiece(ch);
-
-            Bit* bit = PieceForPlayer(playerNumber, piece);
-            bit->setPosition(_grid[row][col].getPosition());
-            bit->setParent(&_grid[row][col]);
-            bit->setGameTag(piece + (playerNumber == 0 ? 128 : 0)); // Use 128 offset for white pieces if needed
-
-            _grid[row][col].setBit(bit);
-
-            col++; // Move to the next column
+    _position.setFromFEN(fen);
+    syncGridFromPosition();
+}
+
+void Chess::syncGridFromPosition() {
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            int square = makeSquare(row, col);
+            ChessSquare &holder = _grid[row][col];
+            Bit *bit = holder.bit();
+            if (_position.isEmpty(square)) {
+                if (bit) {
+                    holder.destroyBit();
+                }
+                continue;
+            }
+            int playerNumber = _position.colorAt(square);
+            ChessPiece piece = _position.pieceAt(square);
+            int gameTag = piece + (playerNumber == 0 ? 128 : 0); // Use 128 offset for white pieces
+            if (bit && bit->gameTag() == gameTag) {
+                continue;
+            }
+            bit = PieceForPlayer(playerNumber, piece);
+            bit->setPosition(holder.getPosition());
+            bit->setParent(&holder);
+            bit->setGameTag(gameTag);
+            holder.setBit(bit);
         }
     }
-
-    // Additional setup based on the rest of the FEN string, if needed
 }
 
 ChessPiece Chess::charToChessPiece(char ch) {
@@ -91,7 +90,7 @@ void Chess::setUpBoard()
         }
     }
 
-    FENtoBoard("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR"); //Standard
+    FENtoBoard(startPositionFEN); //Standard
 
     // FENtoBoard("1r5k/5ppp/8/8/8/8/5PPP/1R3RK1 w - - 0 1"); //checkmate
 
@@ -110,16 +109,14 @@ void Chess::setUpBoard()
     // After the board is set up, evaluate the board and print the score
     // std::string boardState = stateString(); 
     // std::cout << "Initial boardState: " << boardState << std::endl;
-    // int boardScore = evaluateBoard(boardState.c_str());
+    // int boardScore = evaluateBoard(_position);
     // std::cout << "Initial Board Score: " << boardScore << std::endl;
 
-    _lastMove = LastMove(); 
-
     // if (gameHasAI()) {
     //     setAIPlayer(AI_PLAYER)
     // }
 
-    _moves = generateMoves('W', true);
+    _moves = generateMoves();
 
     startGame();
 }
@@ -168,18 +165,10 @@ void Chess::clearBoardHighlights() {
 bool Chess::canBitMoveFrom(Bit& bit, BitHolder& src) {
     ChessSquare& srcSquare = static_cast<ChessSquare&>(src);
     bool canMove = false;
-    for (auto move : _moves) {
-        if (move.from == srcSquare.getNotation()) {
+    for (Move move : _moves) {
+        if (move.from() == srcSquare.getSquareIndex()) {
             canMove = true;
-            for (int y = 0; y < _gameOptions.rowY; y++) {
-                for (int x = 0; x < _gameOptions.rowX; x++) {
-                    ChessSquare& dstSquare = _grid[y][x];
-                    ;
-                    if (move.to == dstSquare.getNotation()) {
-                        dstSquare.setMoveHighlighted(true);
-                    }
-                }
-            }
+            _grid[squareRow(move.to())][squareColumn(move.to())].setMoveHighlighted(true);
         }
     }
     return canMove;
@@ -189,8 +178,8 @@ bool Chess::canBitMoveFromTo(Bit& bit, BitHolder& src, BitHolder& dst)
 {
     ChessSquare &srcSquare = static_cast<ChessSquare&>(src);
     ChessSquare &dstSquare = static_cast<ChessSquare&>(dst);
-    for (auto move : _moves) {
-        if (move.from == srcSquare.getNotation() && move.to == dstSquare.getNotation()) {
+    for (Move move : _moves) {
+        if (move.from() == srcSquare.getSquareIndex() && move.to() == dstSquare.getSquareIndex()) {
             return true;
         }
     }
@@ -198,153 +187,40 @@ bool Chess::canBitMoveFromTo(Bit& bit, BitHolder& src, BitHolder& dst)
 }
 
 void Chess::bitMovedFromTo(Bit& bit, BitHolder& src, BitHolder& dst) {
-    Game::bitMovedFromTo(bit, src, dst);
-
-    // Update lastMove details
     ChessSquare& srcSquare = static_cast<ChessSquare&>(src);
     ChessSquare& dstSquare = static_cast<ChessSquare&>(dst);
-    _lastMove.from = srcSquare.getNotation();
-    _lastMove.to = dstSquare.getNotation();
-    _lastMove.piece = (ChessPiece)(bit.gameTag() & 127);
-    _lastMove.playerNumber = bit.gameTag() >= 128 ? 0 : 1;
-    // _lastMove.isCapture = dstSquare.bit() != nullptr;
-    _lastMove.isCastling = false;
-    // _lastMove.isPawnDoubleMove = false;
-    // std::cout << "isCapture: " << _lastMove.isCapture << std::endl;
-
-    // CASTLING------------------------------------------------------------
-    // Check and update castling flags based on the piece moved
-    if (_lastMove.piece == King) {
-        if (srcSquare.getDistance(dstSquare) == 2) {
-            _lastMove.isCastling = true;
-        }
-        if (_lastMove.playerNumber == 0) { // White King
-            _lastMove.WhiteKingMoved = true;
-        } else { // Black King
-            _lastMove.BlackKingMoved = true;
-        }
-    } 
-    if (_lastMove.piece == Rook) {
-        // std::cout << "Last move from: " << _lastMove.from << std::endl;
-        if (_lastMove.playerNumber == 0) { // White Rook
-            if (_lastMove.from == "h1") {
-                _lastMove.WhiteKingRookMoved = true;
-            } else if (_lastMove.from == "a1") {
-                _lastMove.WhiteQueenRookMoved = true;
-            }
-        } else { // Black Rook
-            if (_lastMove.from == "h8") {
-                _lastMove.BlackKingRookMoved = true;
-            } else if (_lastMove.from == "a8") {
-                _lastMove.BlackQueenRookMoved = true;
+
+    // The grid already shows the piece on dst, play the same move on the position and let the
+    // grid pick up the castling rook, en passant capture or promotion from it.
+    // The AI tells us its exact move, pawns the player pushes to the last rank always become queens.
+    Move played = _engineMove;
+    if (played.from() != srcSquare.getSquareIndex() || played.to() != dstSquare.getSquareIndex()) {
+        played = Move::none();
+        for (Move move : _moves) {
+            if (move.from() == srcSquare.getSquareIndex() && move.to() == dstSquare.getSquareIndex() &&
+                (move.type() != PromotionMove || move.promotion() == Queen)) {
+                played = move;
+                break;
             }
         }
     }
-
-    // Check if the move is a castling move
-    if (_lastMove.isCastling) {
-        // Determine the side (kingside or queenside) and move the rook accordingly
-        int kingFinalCol = dstSquare.getColumn();
-        int rookSrcCol, rookDstCol;
-        if (kingFinalCol == 6) { // Kingside castling
-            rookSrcCol = 7; // Original rook position for kingside castling
-            rookDstCol = 5; // Rook's final position for kingside castling
-        } else if (kingFinalCol == 2) { // Queenside castling
-            rookSrcCol = 0; // Original rook position for queenside castling
-            rookDstCol = 3; // Rook's final position for queenside castling
-        }
-
-        // Move the rook
-        ChessSquare& rookSrcSquare = _grid[dstSquare.getRow()][rookSrcCol];
-        ChessSquare& rookDstSquare = _grid[dstSquare.getRow()][rookDstCol];
-        Bit* rookBit = rookSrcSquare.bit();
-        if (rookBit) {
-            // rookSrcSquare.setBit(nullptr); // Remove the rook from its original position
-            // rookDstSquare.setBit(rookBit); // Place the rook in its new position
-            // // Update the rook's position in the game state if necessary
-            rookDstSquare.setBit(rookBit);
-            rookSrcSquare.setBit(nullptr);
-            rookBit->setPosition(rookDstSquare.getPosition());
+    _engineMove = Move::none();
+    if (played) {
+        if (_position.historyLength() >= maxGamePlies) {
+            _position.clearHistory();
         }
+        _position.makeMove(played);
     }
+    syncGridFromPosition();
 
-    // PROMOTION------------------------------------------------------------
-    // Determine the row index for promotion based on the color of the pawn
-    int promotionRow = bit.gameTag() >= 128 ? 7 : 0; // 0 for white (moving downwards), 7 for black (moving upwards)
-
-    // Check if the bit is a pawn and has reached the promotion row
-    // ChessSquare& srcSquare = static_cast<ChessSquare&>(src);
-    // ChessSquare& dstSquare = static_cast<ChessSquare&>(dst);
-    if ((bit.gameTag() & 127) == Pawn && dstSquare.getRow() == promotionRow) {
-        // Remove the pawn from the board
-        dstSquare.destroyBit();
-
-        // Create a new queen bit and place it on the board at the destination square
-        int playerNumber = (_gameOptions.currentTurnNo & 1) ? 0 : 1; // Determine the player based on the current turn
-        Bit *queenBit = PieceForPlayer(playerNumber, Queen); // Create a queen bit for the player
-
-        // Set the queen's position and parent to the destination square
-        queenBit->setPosition(dstSquare.getPosition());
-        queenBit->setParent(&dstSquare);
-        queenBit->setGameTag(Queen + (playerNumber == 0 ? 128 : 0)); // Set the game tag for the queen, including the color
-
-        // Place the queen on the board
-        dstSquare.setBit(queenBit);
-    }
-
-    // EN PASSANT------------------------------------------------------------
-
-    // Handling en passant capture
-    // std::cout << "dstSquare.getRow(): " << dstSquare.getRow() << std::endl;
-    // std::cout << "_lastMove.enPassantRow: " << _lastMove.enPassantRow << std::endl;
-    if (_lastMove.piece == Pawn && _lastMove.enPassantRow != -1 && dstSquare.getRow() == _lastMove.enPassantRow) {
-        // int currentPlayerNumber = _gameOptions.currentTurnNo % 2;
-        // std::cout << "currentPlayerNumber: " << currentPlayerNumber << std::endl;
-    
-        // The column of the captured pawn is the same as the destination column of the capturing pawn
-        int capturedPawnCol = dstSquare.getColumn();
-        // std::cout << "capturedPawnCol: " << capturedPawnCol << std::endl;
-
-        // Determine the row of the captured pawn based on the color of the capturing pawn
-        int capturedPawnRow = _lastMove.playerNumber == 0 ? 4 : 3; // 4 for white capturing pawn, 3 for black
-        // std::cout << "capturedPawnRow: " << capturedPawnRow << std::endl;
-        // std::cout << "_lastMove.playerNumber: " << _lastMove.playerNumber << std::endl;
-
-        // Remove the captured pawn from the board
-        ChessSquare& capturedSquare = _grid[capturedPawnRow][capturedPawnCol];
-        // if (currentPlayerNumber != _lastMove.playerNumber) {
-        //     capturedSquare.destroyBit();
-        // }
-        capturedSquare.destroyBit();
-        // if (capturedSquare.bit() && capturedSquare.bit()->gameTag() == Pawn) {
-        //     capturedSquare.destroyBit();
-        // }
-        // dstSquare.destroyBit();
-
-        // Update _lastMove to reflect en passant capture specifics if needed
-        // _lastMove.isCapture = false; // Mark this move as a capture
-    }
-    
-    // EN PASSANT------------------------------------------------------------
-    // Check for a pawn double move (en passant eligibility condition)
-    if (_lastMove.piece == Pawn && srcSquare.getDistance(dstSquare) == 2) {
-        _lastMove.isPawnDoubleMove = true;
-        _lastMove.enPassantRow = _lastMove.playerNumber == 0 ? 2 : 5; 
-    } else {
-        _lastMove.isPawnDoubleMove = false;
-        _lastMove.enPassantRow = -1;
-    }
-
-    _moves = generateMoves((_gameOptions.currentTurnNo & 1) ? 'B' : 'W', true);
+    _moves = generateMoves();
 
-    // std::string boardState = stateString(); 
-    // std::cout << "movedd State: " << boardState << std::endl;
-    // int boardScore = evaluateBoard(boardState.c_str());
-    // std::cout << "Initial Board Score: " << boardScore << std::endl;
-    // endTurn();
+    // ends the turn, which checks for a winner, so the position has to be up to date first
+    Game::bitMovedFromTo(bit, src, dst);
 }
 
 void Chess::stopGame() {
+    stopAISearch();
     // Implement any cleanup or finalization needed when the game stops
     // Placeholder, modify as needed
     for (int y=0; y<_gameOptions.rowY; y++) {
@@ -354,16 +230,6 @@ void Chess::stopGame() {
     }
 }
 
-// Helper function to add a move if valid
-void Chess::addMoveIfValid(std::vector<Move>& moves, int fromRow, int fromCol, int toRow, int toCol)
-{
-    if (toRow >= 0 && toRow < 8 && toCol >= 0 && toCol < 8) {
-        if (pieceNotation(fromRow, fromCol)[0] != pieceNotation(toRow, toCol)[0]) { // Ensure not capturing own piece
-            moves.push_back({indexToNotation(fromRow, fromCol), indexToNotation(toRow, toCol)});
-        }
-    }
-}
-
 // Convert row and column index to chess notation
 std::string Chess::indexToNotation(int row, int col)
 {
@@ -382,413 +248,105 @@ void Chess::notationToIndex(const std::string& notation, int &row, int &col) {
 }
 
 
-// Generate moves for a knight
-void Chess::generateKnightMoves(std::vector<Move>& moves, int row, int col) 
+MoveList Chess::generateMoves()
 {
-    static const int movesRow[] = {2, 1, -1, -2, -2, -1, 1, 2};
-    static const int movesCol[] = {1, 2, 2, 1, -1, -2, -2, -1};
-
-    for (int i = 0; i < 8; ++i) {
-        int newRow = row + movesRow[i];
-        int newCol = col + movesCol[i];
-        addMoveIfValid(moves, row, col, newRow, newCol);
-    }
+    MoveList moves;
+    _position.generateMoves(moves);
+    return moves;
 }
 
-void Chess::generatePawnMoves(std::vector<Move>& moves, int row, int col, char color) {
-    int direction = (color == 'B') ? -1 : 1;
-    int startRow = (color == 'B') ? 6 : 1;
-
-    // One square forward
-    if (pieceNotation(row + direction, col) == "00") {
-        addMoveIfValid(moves, row, col, row + direction, col);
-        // Two squares from start row
-        if (row == startRow && pieceNotation(row + 2 * direction, col) == "00") {
-            addMoveIfValid(moves, row, col, row + 2 * direction, col);
-        }
-    }
-
-    // Regular captures
-    for (int i = -1; i <= 1; i += 2) { // -1 for left, +1 for right
-        if (col + i >= 0 && col + i < 8 && row + direction >= 0 && row + direction < 8 && pieceNotation(row + direction, col + i)[0] == oppositeColor(color)) {
-            addMoveIfValid(moves, row, col, row + direction, col + i);
-        }
-    }
-
-    // En passant captures
-    // Adjusting to handle black and white separately
-    // std::cout << "color: " << color << std::endl;
-    int enPassantTriggerRow = (color == 'B') ? 3 : 4; // Row where the pawn must be to potentially capture en passant
-    // std::cout << "enPassantTriggerRow: " << enPassantTriggerRow << std::endl;
-    int enPassantCaptureRow = (color == 'B') ? 2 : 5; // The row to move to when capturing en passant
-    // std::cout << "enPassantCaptureRow: " << enPassantCaptureRow << std::endl;
-    int lastMoveEndRow, lastMoveEndCol;
-    notationToIndex(_lastMove.to, lastMoveEndRow, lastMoveEndCol);
-    // _lastMove.enPassantRow = -1; // Reset the en passant row to -1
-    
-    if (row == enPassantTriggerRow && _lastMove.isPawnDoubleMove) {
-        // Check if the pawn to be captured moved into position beside this pawn
-        if ((lastMoveEndCol == col - 1 || lastMoveEndCol == col + 1)) {
-            // Add the en passant capture move
-            addMoveIfValid(moves, row, col, enPassantCaptureRow, lastMoveEndCol);
-            // std::cout << "row: " << row << std::endl;
-            // std::cout << "col: " << col << std::endl;
-            // std::cout << "enPassantCaptureRow: " << enPassantCaptureRow << std::endl;
-            // _lastMove.enPassantRow = 2;
-            // _lastMove.enPassantRow = enPassantCaptureRow;
-            // std::cout << "_lastMove.enPassantRow : " << _lastMove.enPassantRow  << std::endl;
-        }
-    }
+bool Chess::gameHasAI() {
+    return true; // Indicate that this game supports AI
 }
 
-// Generate moves in a linear direction until blocked
-void Chess::generateLinearMoves(std::vector<Move>& moves, int row, int col, const std::vector<std::pair<int, int>>& directions)
-{
-    for (auto& dir : directions) {
-        int currentRow = row + dir.first;
-        int currentCol = col + dir.second;
-        while (currentRow >= 0 && currentRow < 8 && currentCol >= 0 && currentCol < 8) {
-            if (pieceNotation(currentRow, currentCol) != "00") {
-                addMoveIfValid(moves, row, col, currentRow, currentCol);
-                break; // Stop if there's a piece in the way
-            }
-            addMoveIfValid(moves, row, col, currentRow, currentCol);
-            currentRow += dir.first;
-            currentCol += dir.second;
-        }
+//
+// The search runs on a worker thread so the frame never waits for it. updateAI is called every frame
+// while the AI is to move: the first call starts the search, later ones check whether it has finished
+// and play its move from here on the UI thread.
+// A search started while the human was thinking carries on if they played the move it expected.
+//
+void Chess::updateAI() {
+    if (!getCurrentPlayer()->isAIPlayer()) {
+        return;
     }
-}
-
-// Generate moves for a bishop
-void Chess::generateBishopMoves(std::vector<Move>& moves, int row, int col)
-{
-    static const std::vector<std::pair<int, int>> directions = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}}; // diagonals
-    generateLinearMoves(moves, row, col, directions);
-}
-
-// Generate moves for a rook
-void Chess::generateRookMoves(std::vector<Move>& moves, int row, int col)
-{
-    static const std::vector<std::pair<int, int>> directions = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}}; // straight lines
-    generateLinearMoves(moves, row, col, directions);
-}
-
-void Chess::generateQueenMoves(std::vector<Move>& moves, int row, int col) {
-    generateRookMoves(moves, row, col);
-    generateBishopMoves(moves, row, col);
-}
-
-void Chess::generateKingMoves(std::vector<Move>& moves, int row, int col)
-{
-    static const std::vector<std::pair<int, int>> directions = {
-        {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}
-    }; // All 8 directions around the king
-    
-    for (auto& dir : directions) {
-        int newRow = row + dir.first;
-        int newCol = col + dir.second;
-        if (newRow >= 0 && newRow < 8 && newCol >= 0 && newCol < 8) {
-            addMoveIfValid(moves, row, col, newRow, newCol);
+    if (_pondering) {
+        _pondering = false;
+        if (_position.key() == _aiSearchKey) {
+            _engine.ponderHit();
+        } else {
+            stopAISearch();
         }
     }
-
-    // Castling logic
-    if ((row == 0 && col == 4 && !_lastMove.WhiteKingMoved) || (row == 7 && col == 4 && !_lastMove.BlackKingMoved)) {
-        // White's castling
-        // std::cout << "row: " << row << std::endl;
-        if (row == 0) {
-            // Kingside castling for White
-            if (!_lastMove.WhiteKingRookMoved && _grid[0][5].bit() == nullptr && _grid[0][6].bit() == nullptr) {
-                moves.push_back({"e1", "g1"}); // Ensure no check conditions along the path
-            }
-            // Queenside castling for White
-            if (!_lastMove.WhiteQueenRookMoved && _grid[0][3].bit() == nullptr && _grid[0][2].bit() == nullptr && _grid[0][1].bit() == nullptr) {
-                moves.push_back({"e1", "c1"}); // Ensure no check conditions along the path
-            }
-        }
-        // Black's castling
-        else if (row == 7) {
-            // Kingside castling for Black
-            if (!_lastMove.BlackKingRookMoved && _grid[7][5].bit() == nullptr && _grid[7][6].bit() == nullptr) {
-                moves.push_back({"e8", "g8"}); // Ensure no check conditions along the path
-            }
-            // Queenside castling for Black
-            if (!_lastMove.BlackQueenRookMoved && _grid[7][3].bit() == nullptr && _grid[7][2].bit() == nullptr && _grid[7][1].bit() == nullptr) {
-                moves.push_back({"e8", "c8"}); // Ensure no check conditions along the path
-            }
+    if (!_aiSearch.valid()) {
+        // nothing to search once the game is over, the frame loop keeps calling while the AI is to move
+        if (checkForWinner() || checkForDraw()) {
+            return;
         }
+        startAISearch(_position, false);
+        return;
     }
-}
-
-char Chess::oppositeColor(char color)
-{
-    return (color == 'W') ? 'B' : 'W';
-}
-
-std::vector<Chess::Move> Chess::generateMoves(char color, bool filter)
-{
-    std::vector<Move> moves;
-
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            std::string piece = pieceNotation(row, col);
-            if (!piece.empty() && piece != "00" && piece[0] == color) {
-                switch (piece[1]) {
-                    case 'N': // Knight
-                        generateKnightMoves(moves, row, col);
-                        break;
-                    case 'P': // Pawn
-                        generatePawnMoves(moves, row, col, piece[0]);
-                        break;
-                    case 'B': // Bishop
-                        generateBishopMoves(moves, row, col);
-                        break;
-                    case 'R': // Rook
-                        generateRookMoves(moves, row, col);
-                        break;
-                    case 'Q': // Queen
-                        generateQueenMoves(moves, row, col);
-                        break;
-                    case 'K': // King
-                        generateKingMoves(moves, row, col);
-                        break;
-                    // ... other cases for other pieces if necessary
-                }
-            }
+    if (_aiSearch.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        SearchResult result = _aiSearch.get();
+        // copied while the engine is idle, the settings window reads it every frame
+        _searchStats = _engine.threadStats();
+        // the game may have moved on while the search ran, then its answer is for another position
+        if (_position.key() == _aiSearchKey) {
+            performAIMove(result);
         }
     }
-    if (filter) {
-        filterOutIllegalMoves(moves, color);
-    }
-    return moves;
-}
-
-std::map<std::string, int> scores = {
-    {"WP", 100},  {"BP", -100},
-    {"WN", 200},  {"BN", -200},
-    {"WB", 230},  {"BB", -230},
-    {"WR", 400},  {"BR", -400},
-    {"WQ", 900},  {"BQ", -900},
-    {"WK", 2000}, {"BK", -2000},
-    {"00", 0} // Assuming '00' is used for empty squares
-};
-
-int Chess::evaluateBoard(const char* state) {
-    // std::map<char, int> scores = {
-    //     {'p', 100},  {'P', -100},
-    //     {'n', 200},  {'N', -200},
-    //     {'b', 230},  {'B', -230},
-    //     {'r', 400},  {'R', -400},
-    //     {'q', 900},  {'Q', -900},
-    //     {'k', 2000}, {'K', -2000},
-    //     {'e', 0}
-    // };
-
-    // std::map<std::string, int> scores = {
-    //     {"WP", 100},  {"BP", -100},
-    //     {"WN", 200},  {"BN", -200},
-    //     {"WB", 230},  {"BB", -230},
-    //     {"WR", 400},  {"BR", -400},
-    //     {"WQ", 900},  {"BQ", -900},
-    //     {"WK", 2000}, {"BK", -2000},
-    //     {"00", 0} // Assuming '00' is used for empty squares
-    // };
-
-    int score = 0;
-    for (int i = 0; i < 128; i += 2) { // Increment by 2 because each piece is represented by two characters
-        // std::cout << "i: " << i << std::endl;
-        std::string piece(state + i, state + i + 2); // Create a substring for each piece
-        // std::cout << "boardState: " << piece << std::endl;
-        score += scores[piece];
-        // std::cout << "current score: " << score << std::endl;
-    }
-
-    return score;
 }
 
-Chess::LastMove Chess::applyMove(Move& move) {
-    // Convert move notation to board indices
-    int fromRow, fromCol, toRow, toCol;
-    notationToIndex(move.from, fromRow, fromCol);
-    notationToIndex(move.to, toRow, toCol);
-
-    Bit* movedBit = _grid[fromRow][fromCol].bit();
-    Bit* capturedBit = _grid[toRow][toCol].bit();
-
-    LastMove savedMove;
-
-    // Update the LastMove with details of this move
-    savedMove.from = move.from;
-    savedMove.to = move.to;
-    // savedMove.piece = (ChessPiece)(movedBit.gameTag() & 127);
-    savedMove.piece = movedBit ? (ChessPiece)(movedBit->gameTag() & 127) : NoPiece;
-    savedMove.movePiece = movedBit;
-    savedMove.playerNumber = movedBit && (movedBit->gameTag() >= 128) ? 0 : 1;
-    savedMove.capturedPiece = capturedBit; // Store the captured piece
-
-    // Simulate the move
-    if (movedBit) {
-        // std::cout << "did it" << std::endl;
-        _grid[toRow][toCol].setBitOverride(movedBit); // Move the piece to the new location
-        movedBit->moveTo(_grid[toRow][toCol].getPosition());
-        movedBit->setParent(&_grid[toRow][toCol]);
-        _grid[fromRow][fromCol].setBitOverride(nullptr); // Clear the old location
-    }
-    return savedMove;
-}
+void Chess::startAISearch(const Position &position, bool ponder) {
+    _engine.setHashSizeMB(_gameOptions.AIHashSizeMB);
+    _engine.setThreads(_gameOptions.AIThreads);
+    _engine.setSearchMode((SearchMode)_gameOptions.AISearchMode);
 
-void Chess::undoMove(LastMove& lastMove) {
-    // Convert move notation back to board indices
-    int fromRow, fromCol, toRow, toCol;
-    notationToIndex(lastMove.from, fromRow, fromCol);
-    notationToIndex(lastMove.to, toRow, toCol);
-
-    // Retrieve the moved and potentially captured pieces from the LastMove object
-    Bit* movedBit = lastMove.movePiece;
-    Bit* capturedBit = lastMove.capturedPiece;
-
-    // Revert the move
-    if (movedBit) {
-        // Move the piece back to its original location
-        _grid[fromRow][fromCol].setBitOverride(movedBit);
-        movedBit->moveTo(_grid[fromRow][fromCol].getPosition());
-        movedBit->setParent(&_grid[fromRow][fromCol]);
-
-        // Restore the captured piece, if there was one
-        if (capturedBit) {
-            _grid[toRow][toCol].setBitOverride(capturedBit);
-            capturedBit->moveTo(_grid[toRow][toCol].getPosition());
-            capturedBit->setParent(&_grid[toRow][toCol]);
-        } else {
-            // If there was no captured piece, ensure the destination is cleared
-            _grid[toRow][toCol].setBitOverride(nullptr);
-        }
-    }
-}
+    SearchLimits limits;
+    limits.maxDepth = _gameOptions.AIMAXDepth;
+    limits.moveTimeMs = _gameOptions.AIMoveTimeMs;
+    limits.ponder = ponder;
 
-bool Chess::gameHasAI() {
-    return true; // Indicate that this game supports AI
+    _aiSearchKey = position.key();
+    _aiSearch = _engine.startThinking(position, limits);
+    _pondering = ponder;
 }
 
-void Chess::updateAI() {
-    if (getCurrentPlayer()->isAIPlayer()) {
-        performAIMove(); // Make the best move for the AI
+void Chess::startPondering(Move expectedReply) {
+    if (!_gameOptions.AIPonder || getCurrentPlayer()->isAIPlayer() || !_moves.contains(expectedReply)) {
+        return;
     }
+    Position position = _position;
+    position.makeMove(expectedReply);
+    startAISearch(position, true);
 }
 
-int Chess::negamax(int depth, int alpha, int beta, int color) {
-    // if (depth == 0 || checkForWinner() || checkForDraw()) {
-    //     return color * evaluateBoard(stateString().c_str());
-    // }
-
-    if (depth == 0) {
-        return color * evaluateBoard(stateString().c_str());
-    }
-
-        // counter++;
-        // std::cout << "negamax:" << counter << std::endl;
-
-    std::vector<Move> moves = generateMoves(color == 1 ? 'W' : 'B', true);
-    if (moves.empty()) {
-        // Adjust scoring for checkmate and stalemate if necessary
-        return color * -10000; // Placeholder score for checkmate or specific terminal condition
+void Chess::stopAISearch() {
+    if (_aiSearch.valid()) {
+        _engine.stop();
+        _aiSearch.wait();
+        _aiSearch = std::future<SearchResult>();
     }
-
-    int maxScore = INT_MIN;
-    for (auto move : moves) {
-        LastMove savedMove = applyMove(move);
-        
-        // Now using alpha and beta for pruning
-        int score = -negamax(depth - 1, -beta, -alpha, -color);
-
-        undoMove(savedMove);
-
-        if (score > maxScore) maxScore = score;
-        alpha = std::max(alpha, score);
-        if (alpha >= beta) break; // Alpha-beta pruning
-    }
-
-    return maxScore;
+    _pondering = false;
 }
 
-void Chess::performAIMove() {
-    const int myInfinity = 1000000; // Use a large value for infinity
-    int bestScore = -myInfinity;
-    Move bestMove;
+void Chess::performAIMove(const SearchResult &result) {
+    _gameOptions.AIDepthSearches = result.depth;
+    Move bestMove = result.bestMove;
 
-    int alpha = -myInfinity;
-    int beta = myInfinity;
-    int color = -1; // Assuming AI plays as Black (-1), use 1 for White
-
-    std::vector<Move> moves = generateMoves('B', true); // Assuming AI plays as Black
-    for (auto move : moves) {
-        LastMove savedMove = applyMove(move);
-
-        // Negamax search with Alpha-Beta pruning, flipping color (-color)
-        int score = -negamax(3, -beta, -alpha, -color); // Depth set to 3 or another value based on your requirement
-        
-        undoMove(savedMove);
-
-        if (score > bestScore) {
-            bestScore = score;
-            bestMove = move;
-        }
-        alpha = std::max(alpha, score);
-        if (alpha >= beta) break; // Alpha-beta pruning
-    }
-
-    // Perform the best move found
-    if (!bestMove.from.empty()) {
-        int fromRow, fromCol, toRow, toCol;
-        notationToIndex(bestMove.from, fromRow, fromCol);
-        notationToIndex(bestMove.to, toRow, toCol);
-
-        BitHolder& src = getHolderAt(fromRow, fromCol);
-        BitHolder& dst = getHolderAt(toRow, toCol);
+    // Perform the best move found, bitMovedFromTo plays it on the position
+    if (bestMove) {
+        BitHolder& src = getHolderAt(squareRow(bestMove.from()), squareColumn(bestMove.from()));
+        BitHolder& dst = getHolderAt(squareRow(bestMove.to()), squareColumn(bestMove.to()));
         Bit* bit = src.bit();
         dst.dropBitAtPoint(bit, ImVec2(0, 0));
         src.setBit(nullptr);
+        _engineMove = bestMove;
         bitMovedFromTo(*bit, src, dst);
+        // think about our next move while the human thinks about theirs
+        startPondering(result.ponderMove);
     }
 }
 
-// void Chess::filterOutIllegalMoves(std::vector<Chess::Move>& moves, char color) {
-//     char baseState[65];
-//     std::string copyState = stateString();
-
-//     // stateString().c_str()
-//     //
-//     // find out where the king is
-//     //
-//     int kingSquare = -1;
-//     for (int i=0; i<64; i++) {
-//         if (copyState[i] == 'k' && color == 'B') { kingSquare = i; break; }
-//         if (copyState[i] == 'K' && color == 'W') { kingSquare = i; break; }
-//     }
-
-//     for (auto it = moves.begin(); it != moves.end(); ) {
-//         bool moveBad = false;
-//         strcpy(&baseState[0], copyState.c_str());
-//         int srcSquare = notationToIndex(it->from);
-//         int dstSquare = notationToIndex(it->to);
-//         baseState[dstSquare] = baseState[srcSquare];
-//         baseState[srcSquare] = '0';
-//         auto oppositeMoves = generateMoves(baseState, color == 'W' ? 'B' : 'W', false);
-//         for (auto enemyMoves : oppositeMoves) {
-//             int enemyDst = notationToIndex(enemyMoves.to);
-//             if (enemyDst == kingSquare) {
-//                 moveBad = true;
-//                 break;
-//             }
-//         }
-//         if (moveBad) {
-//             it = moves.erase(it);
-//         } else {
-//             ++it;
-//         }
-//     }
-// }
-
 static std::map<char, ChessPiece> ChessPieces = {
         {'P', Pawn},
         {'N', Knight},
@@ -801,6 +359,10 @@ static std::map<char, ChessPiece> ChessPieces = {
 
 void Chess::setStateString(const std::string &s)
 {
+    // the state string only holds the pieces, so whose turn it is comes from the turn number
+    // and castling is kept only where the king and rook are still at home
+    int castlingRights = _position.castlingRights();
+    _position.clear();
     for (int y=0; y<_gameOptions.rowY; y++) {
         for (int x=0; x<_gameOptions.rowX; x++) {
             int index = y*_gameOptions.rowX + x;
@@ -814,93 +376,34 @@ void Chess::setStateString(const std::string &s)
 
                 _grid[y][x].setBitOverride(bit);
                 // _grid[y][x].setBit( PieceForPlayer(playerNumber, piece) );
+                _position.putPiece(index, (ChessColor)playerNumber, piece);
             } else {
                 _grid[y][x].setBitOverride( nullptr );
             }
         }
     }
-}
-
-void Chess::filterOutIllegalMoves(std::vector<Chess::Move>& moves, char color) {
-    // return;
-    char baseState[129];
-    std::string copyState = std::string(stateString().c_str());
-
-    // std::cout << "copied state: " << copyState << std::endl;
-
-    // find out where the king is
-    int kingSquare = -1;
-    for (int i=0; i< 128; i+=2) {
-        if (copyState[i] == color && copyState[i+1] == 'K') { kingSquare = i/2; break; }
-    }
-
-    for (auto it = moves.begin(); it != moves.end(); ) {
-        bool moveBad = false;
-        memcpy(&baseState[0], copyState.c_str(), 128);
-
-        // Convert source and destination from notation to row and column
-        int srcRow, srcCol, dstRow, dstCol;
-        notationToIndex(it->from, srcRow, srcCol);
-        notationToIndex(it->to, dstRow, dstCol);
-
-        // Convert row and column back to index for baseState
-        int srcSquare = srcRow * 8 + srcCol;
-        int dstSquare = dstRow * 8 + dstCol;
-
-        baseState[dstSquare * 2 + 0] = baseState[srcSquare * 2 + 0];
-        baseState[dstSquare * 2 + 1] = baseState[srcSquare * 2 + 1];
-        baseState[srcSquare * 2 + 0] = '0';
-        baseState[srcSquare * 2 + 1] = '0';
-
-        setStateString(baseState);
-
-        // Handle the case in which the king is the piece that moved, and it may have left or remained in check
-        int updatedKingSquare = kingSquare;
-        if (baseState[dstSquare * 2 + 1] == 'K')
-        {
-            updatedKingSquare = dstSquare;
-        }
-
-        auto oppositeMoves = generateMoves(color == 'W' ? 'B' : 'W', false);
-        for (auto enemyMove : oppositeMoves) {
-            int enemyRow, enemyCol;
-            notationToIndex(enemyMove.to, enemyRow, enemyCol);
-            int enemyDst = enemyRow * 8 + enemyCol;
-            if (enemyDst == updatedKingSquare) {
-                moveBad = true;
-                break;
-            }
-        }
-
-        if (moveBad) {
-            it = moves.erase(it);
-        } else {
-            ++it;
-        }
-    }
-    setStateString(copyState);
+    // rights whose king or rook has moved are dropped by the position
+    _position.setCastlingRights(castlingRights);
+    _position.setSideToMove((_gameOptions.currentTurnNo & 1) ? Black : White);
+    _moves = generateMoves();
 }
 
 Player* Chess::checkForWinner() {
-    char currentPlayerColor = (_gameOptions.currentTurnNo & 1) ? 'B' : 'W';
-    std::vector<Move> moves = generateMoves(currentPlayerColor, true); // Generate all legal moves for the current player
+    MoveList moves = generateMoves(); // Generate all legal moves for the current player
 
-    if (moves.empty()) { // No legal moves available
-        if (isKingInCheck(currentPlayerColor)) { // Check if the current player's king is in check
-            // If the king is in check and there are no legal moves, it's checkmate
-            return currentPlayerColor == 'W' ? getPlayerAt(1) : getPlayerAt(0); // Return the winner (opposite player)
-        }
+    if (moves.empty() && _position.inCheck()) {
+        // If the king is in check and there are no legal moves, it's checkmate
+        return getPlayerAt(oppositeColor(_position.sideToMove())); // Return the winner (opposite player)
     }
-    
+
     // std::cout << "Winnter:" << currentPlayerColor << std::endl;
     return nullptr; // No checkmate detected, no winner yet
 }
 
 bool Chess::checkForDraw() {
-    char currentPlayerColor = (_gameOptions.currentTurnNo & 1) ? 'B' : 'W';
-    std::vector<Move> moves = generateMoves(currentPlayerColor, true); // Generate all legal moves for the current player
+    MoveList moves = generateMoves(); // Generate all legal moves for the current player
 
-    if (moves.empty() && !isKingInCheck(currentPlayerColor)) {
+    if (moves.empty() && !_position.inCheck()) {
         // If there are no legal moves and the king is not in check, it's a stalemate
         return true;
     }
@@ -916,44 +419,15 @@ bool Chess::checkForDraw() {
 }
 
 bool Chess::isInsufficientMaterial() {
-    int piecesCount = 0;
-    for (int y = 0; y < _gameOptions.rowY; ++y) {
-        for (int x = 0; x < _gameOptions.rowX; ++x) {
-            if (_grid[y][x].bit() != nullptr) { // There's a piece on this square
-                piecesCount++;
-            }
-        }
-    }
-
-    // If the count is exactly 2, then only the two kings are left
-    return piecesCount == 2;
+    // king against king, or against king and a single knight or bishop, looked up by the material key
+    return Material::probe(_position.materialKey()).insufficient;
 }
 
 
 bool Chess::isKingInCheck(char playerColor) {
-    // Find the king's position
-    std::string kingPosition = "";
-    for (int y = 0; y < _gameOptions.rowY; ++y) {
-        for (int x = 0; x < _gameOptions.rowX; ++x) {
-            std::string pieceNotation = this->pieceNotation(y, x);
-            if (pieceNotation[0] == playerColor && pieceNotation[1] == 'K') {
-                kingPosition = indexToNotation(y, x);
-                break;
-            }
-        }
-    }
-
-    if (kingPosition.empty()) return false; // If the king's position is not found, return false (shouldn't happen)
+    ChessColor color = (playerColor == 'W') ? White : Black;
+    int king = _position.kingSquare(color);
+    if (king == NoSquare) return false; // If the king's position is not found, return false (shouldn't happen)
 
-    // Check if any of the opponent's moves can capture the king
-    char opponentColor = (playerColor == 'W') ? 'B' : 'W';
-    std::vector<Move> opponentMoves = generateMoves(opponentColor, false); // Generate all moves for the opponent, without filtering for legality
-    for (const Move& move : opponentMoves) {
-        if (move.to == kingPosition) {
-            return true; // The king is in check if any opponent move can capture the king's position
-        }
-    }
-
-    return false; // The king is not in check
+    return _position.isSquareAttacked(king, oppositeColor(color));
 }
-
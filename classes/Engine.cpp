@@ -0,0 +1,142 @@
+#include "Engine.h"
+#include <thread>
+
+Engine::Engine() : _mode(LazySMPSearch) {
+    setThreads(1);
+}
+
+Engine::~Engine() {
+    // pool tasks point at the searches, so the pool goes first
+    _pool.reset();
+}
+
+void Engine::setThreads(int threads) {
+    threads = std::max(threads, 1);
+    if (threads == (int)_searches.size()) {
+        return;
+    }
+    _pool.reset();
+    while ((int)_searches.size() > threads) {
+        _searches.pop_back();
+    }
+    while ((int)_searches.size() < threads) {
+        _searches.push_back(std::make_unique<Search>(_transpositionTable, _signals, (int)_searches.size()));
+    }
+    updatePool();
+}
+
+void Engine::setSearchMode(SearchMode mode) {
+    if (mode == _mode) {
+        return;
+    }
+    _mode = mode;
+    updatePool();
+}
+
+void Engine::updatePool() {
+    bool wantPool = _mode == YoungBrothersSearch && _searches.size() > 1;
+    if (wantPool && !_pool) {
+        _pool = std::make_unique<ThreadPool>((int)_searches.size() - 1);
+    } else if (!wantPool) {
+        _pool.reset();
+    }
+    // pool worker i runs in search i, the one thread 0 isn't using
+    std::vector<Search *> workers;
+    for (size_t i = 1; i < _searches.size(); i++) {
+        workers.push_back(_searches[i].get());
+    }
+    for (auto &search : _searches) {
+        search->setSplitting(_pool.get(), workers);
+    }
+}
+
+void Engine::clear() {
+    _transpositionTable.clear();
+    for (auto &search : _searches) {
+        search->clear();
+    }
+}
+
+// the signals are set up before the worker starts, so a stop or ponder hit sent right after can't be lost
+std::future<SearchResult> Engine::startThinking(const Position &position, const SearchLimits &limits) {
+    _signals.stop.store(false, std::memory_order_relaxed);
+    _signals.nodes.store(0, std::memory_order_relaxed);
+    _signals.pondering.store(limits.ponder, std::memory_order_release);
+    _signals.clockStartMs.store(Search::clockMs(), std::memory_order_release);
+    return std::async(std::launch::async, [this, position, limits] {
+        return run(position, limits);
+    });
+}
+
+void Engine::ponderHit() {
+    _signals.clockStartMs.store(Search::clockMs(), std::memory_order_release);
+    _signals.pondering.store(false, std::memory_order_release);
+}
+
+void Engine::waitWhilePondering() {
+    while (_signals.pondering.load(std::memory_order_acquire) && !_signals.stop.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+SearchResult Engine::run(const Position &position, const SearchLimits &limits) {
+    _transpositionTable.newSearch();
+    for (auto &search : _searches) {
+        search->resetStats();
+    }
+    if (_pool) {
+        _pool->resetStats();
+    }
+
+    SearchResult result;
+    if (_mode == LazySMPSearch) {
+        result = runLazySMP(position, limits);
+    } else {
+        // serial, or young brothers wait where thread 0 brings in the pool itself
+        result = _searches[0]->think(position, limits);
+        waitWhilePondering();
+    }
+
+    _threadStats.assign(_searches.size(), ThreadStats());
+    std::vector<ThreadPool::WorkerStats> poolStats = _pool ? _pool->stats() : std::vector<ThreadPool::WorkerStats>();
+    result.nodes = 0;
+    for (size_t i = 0; i < _searches.size(); i++) {
+        ThreadStats &stats = _threadStats[i];
+        stats.nodes = _searches[i]->nodes();
+        stats.splits = _searches[i]->splits();
+        stats.helpedMoves = _searches[i]->helpedMoves();
+        if (i > 0 && i - 1 < poolStats.size()) {
+            stats.tasks = poolStats[i - 1].tasks;
+            stats.steals = poolStats[i - 1].steals;
+        }
+        result.nodes += stats.nodes;
+    }
+    return result;
+}
+
+SearchResult Engine::runLazySMP(const Position &position, const SearchLimits &limits) {
+    std::vector<SearchResult> results(_searches.size());
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < _searches.size(); i++) {
+        helpers.emplace_back([this, &results, &position, &limits, i] {
+            results[i] = _searches[i]->think(position, limits);
+        });
+    }
+    results[0] = _searches[0]->think(position, limits);
+    waitWhilePondering();
+    // the helpers have no say in when the search ends, they run until the main search is done
+    stop();
+    for (auto &helper : helpers) {
+        helper.join();
+    }
+
+    // a deeper result saw more, at the same depth the better score was searched with more help from the table
+    SearchResult best = results[0];
+    for (size_t i = 1; i < results.size(); i++) {
+        const SearchResult &result = results[i];
+        if (result.bestMove && (result.depth > best.depth || (result.depth == best.depth && result.score > best.score))) {
+            best = result;
+        }
+    }
+    return best;
+}
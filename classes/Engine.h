@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Search.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+
+// how the engine uses its threads, can be changed between searches
+enum SearchMode {
+    SerialSearch,       // a single thread whatever threads() says
+    LazySMPSearch,      // every thread searches the whole tree, they only share the transposition table
+    YoungBrothersSearch // one tree, the moves after the first at a deep node are shared out over a work stealing pool
+};
+
+// what one thread did during the last search
+struct ThreadStats
+{
+    uint64_t nodes = 0;
+    uint64_t splits = 0;      // nodes it shared out to the pool
+    uint64_t helpedMoves = 0; // moves it searched at another thread's split point
+    uint64_t tasks = 0;       // pool tasks it ran
+    uint64_t steals = 0;      // of those, how many it took from another thread's queue
+};
+
+//
+// Engine owns the transposition table and the searches, it is all the game needs to ask for a move.
+// With Lazy SMP every thread searches the same root on its own copy of the position, sharing only
+// the transposition table, and odd threads run a ply ahead so their results reach the others sooner.
+// Thread 0 decides when to stop and the deepest result wins.
+// With young brothers wait there is a single search, thread 0, which hands work to a pool of the others.
+//
+class Engine
+{
+public:
+    Engine();
+    ~Engine();
+
+    void setHashSizeMB(int megabytes) { _transpositionTable.resize(megabytes); }
+    int hashSizeMB() const { return _transpositionTable.sizeMB(); }
+    // permille of the transposition table filled by the current search
+    int hashfull() const { return _transpositionTable.hashfull(); }
+    void setThreads(int threads);
+    int threads() const { return (int)_searches.size(); }
+    void setSearchMode(SearchMode mode);
+    SearchMode searchMode() const { return _mode; }
+    // forget everything learned, for a new game
+    void clear();
+
+    // starts searching on a worker thread and returns at once, the result arrives through the future.
+    // nothing else may be changed on the engine until it has
+    std::future<SearchResult> startThinking(const Position &position, const SearchLimits &limits);
+    // searches until the limits are reached, blocking the caller
+    SearchResult think(const Position &position, const SearchLimits &limits) { return startThinking(position, limits).get(); }
+    // the search ends soon after, may be called from another thread
+    void stop() { _signals.stop.store(true, std::memory_order_relaxed); }
+    // the opponent played the move a ponder search assumed, its time limits start counting now
+    void ponderHit();
+
+    // one entry per thread, thread 0 first
+    const std::vector<ThreadStats> &threadStats() const { return _threadStats; }
+
+private:
+    // makes the pool match the mode and thread count
+    void updatePool();
+    SearchResult run(const Position &position, const SearchLimits &limits);
+    SearchResult runLazySMP(const Position &position, const SearchLimits &limits);
+    // a ponder search that finishes early keeps its answer until the ponder hit or stop
+    void waitWhilePondering();
+
+    TranspositionTable _transpositionTable;
+    SearchSignals _signals;
+    SearchMode _mode;
+    std::vector<std::unique_ptr<Search>> _searches;
+    std::unique_ptr<ThreadPool> _pool;
+    std::vector<ThreadStats> _threadStats;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Bitboard.h"
+#include <vector>
+
+class Position;
+
+// a middlegame and an endgame value, the evaluation blends the two by how much material is left
+struct Score
+{
+    int mg = 0;
+    int eg = 0;
+
+    Score &operator+=(const Score &other) { mg += other.mg; eg += other.eg; return *this; }
+    Score &operator-=(const Score &other) { mg -= other.mg; eg -= other.eg; return *this; }
+};
+
+//
+// Pawn structure scores by pawn key. Pawns move rarely, so nearly every lookup finds its answer here.
+// Each search thread has its own, so there is no locking.
+//
+class PawnTable
+{
+public:
+    struct Entry
+    {
+        uint64_t key = 0;
+        Score score; // white positive
+    };
+
+    PawnTable() : _entries(entryCount) {}
+
+    // the slot for key, which holds some other key's score when key isn't in it
+    Entry &slot(uint64_t key) { return _entries[key & (entryCount - 1)]; }
+
+private:
+    static const int entryCount = 1 << 14;
+    std::vector<Entry> _entries;
+};
+
+//
+// Static evaluation. Material and piece placement come from piece-square tables that already include
+// each piece's value. Position keeps their sum up to date as pieces come and go, so reading it is free.
+//
+namespace Evaluation {
+    // fills the tables, safe to call more than once
+    void init();
+
+    // white's pieces count positive and black's negative, by piece and square
+    extern Score pieceSquare[2][7][64];
+
+    // each piece left adds its weight to the game phase, all of them together make maxPhase, the middlegame
+    extern const int phaseWeight[7];
+    const int maxPhase = 24;
+
+    // doubled, isolated, backward and passed pawns of both sides, white positive
+    Score evaluatePawns(const Position &position);
+
+    // from the point of view of the side to move
+    int evaluate(const Position &position, PawnTable &pawnTable);
+}
@@ -15,7 +15,13 @@ Game::Game()
 	_gameOptions.rowY = 0;
 	_gameOptions.score = 0;
 	_gameOptions.AIDepthSearches = 0;
+	_gameOptions.AIMAXDepth = 64;
+	_gameOptions.AIMoveTimeMs = 1000;
 	_gameOptions.AIvsAI = false;
+	_gameOptions.AIHashSizeMB = 16;
+	_gameOptions.AIThreads = std::max(1, (int)std::thread::hardware_concurrency());
+	_gameOptions.AISearchMode = 1; // Lazy SMP
+	_gameOptions.AIPonder = true;
 
 	_table = nullptr;
 	_winner = nullptr;
@@ -34,16 +34,21 @@ struct GameOptions
 	int gameNumber;
 	unsigned int currentTurnNo;
 	int score;
-	int AIDepthSearches;
-	int AIMAXDepth;
+	int AIDepthSearches; // depth the last AI search completed
+	int AIMAXDepth;		 // deepest the AI iterates to
+	int AIMoveTimeMs;	 // time the AI may think per move
 	bool AIvsAI;
+	int AIHashSizeMB; // size of the AI's transposition table
+	int AIThreads;	  // threads the AI searches with, they share the transposition table
+	int AISearchMode; // how those threads split the work, one of the engine's SearchModes
+	bool AIPonder;	  // let the AI keep thinking during the human's turn
 };
 
 class Game
 {
 public:
 	Game();
-	~Game();
+	virtual ~Game();
 
 	void startGame();
 
@@ -100,6 +105,8 @@ public:
 	void setAIPlayer(unsigned int playerNumber);
 	virtual int getAIDepathSearches() { return _gameOptions.AIDepthSearches; };
 	virtual int getAIMAXDepth() { return _gameOptions.AIMAXDepth; };
+	int getAISearchMode() { return _gameOptions.AISearchMode; };
+	void setAISearchMode(int mode) { _gameOptions.AISearchMode = mode; };
 
 	// mouse functions
 	void scanForMouse();
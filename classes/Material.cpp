@@ -0,0 +1,127 @@
+#include "Material.h"
+#include <mutex>
+#include <vector>
+
+// the largest count per piece the table covers, pawn to queen
+static const int tableLimit[7] = { 0, 8, 2, 2, 2, 1, 0 };
+static const int perSide = 9 * 3 * 3 * 3 * 2;
+
+// piece values for telling who is ahead without pawns
+static const int pieceValue[7] = { 0, 82, 337, 365, 477, 1025, 0 };
+
+static const Score bishopPair = { 30, 50 };
+// knights get better and rooks worse the more pawns are left, counted from five
+static const Score knightPerPawn = { 3, 4 };
+static const Score rookPerPawn = { -6, -8 };
+
+static std::vector<MaterialEntry> table;
+
+static int nonPawnMaterial(uint64_t key, ChessColor color)
+{
+    int total = 0;
+    for (int piece = Knight; piece <= Queen; piece++) {
+        total += pieceValue[piece] * Material::count(key, color, (ChessPiece)piece);
+    }
+    return total;
+}
+
+static MaterialEntry compute(uint64_t key)
+{
+    MaterialEntry entry;
+    int pawns[2] = { Material::count(key, White, Pawn), Material::count(key, Black, Pawn) };
+    int material[2] = { nonPawnMaterial(key, White), nonPawnMaterial(key, Black) };
+
+    // a lone king, or a king with a single minor piece, can't mate whatever the other side does
+    for (int color = White; color <= Black; color++) {
+        ChessColor us = (ChessColor)color;
+        ChessColor them = oppositeColor(us);
+        bool onlyMinor = pawns[us] == 0 && material[us] <= pieceValue[Bishop] &&
+                         Material::count(key, us, Rook) == 0 && Material::count(key, us, Queen) == 0;
+        if (onlyMinor) {
+            entry.scale[us] = 0;
+        } else if (pawns[us] == 0 && material[us] - material[them] <= pieceValue[Bishop]) {
+            // without pawns a small edge rarely wins: a rook against a minor piece is mostly a draw
+            entry.scale[us] = material[us] < pieceValue[Rook] ? 0 : (material[them] <= pieceValue[Bishop] ? 4 : 14);
+        } else if (pawns[us] == 0 && pawns[them] == 0 && material[them] == 0 &&
+                   Material::count(key, us, Knight) == 2 && material[us] == 2 * pieceValue[Knight]) {
+            // two knights can't force mate on a bare king
+            entry.scale[us] = 0;
+        }
+    }
+    // only a bare king against a king with at most one minor piece is dead whatever happens. minor against minor
+    // can still be mated into a corner, and the key can't tell bishop colours apart, so those are left to scale
+    int minors = 0;
+    for (int color = White; color <= Black; color++) {
+        minors += Material::count(key, (ChessColor)color, Knight) + Material::count(key, (ChessColor)color, Bishop);
+    }
+    entry.insufficient = pawns[White] == 0 && pawns[Black] == 0 && material[White] + material[Black] <= pieceValue[Bishop] && minors <= 1;
+
+    for (int color = White; color <= Black; color++) {
+        ChessColor us = (ChessColor)color;
+        Score side;
+        if (Material::count(key, us, Bishop) >= 2) {
+            side += bishopPair;
+        }
+        int pawnsOverFive = pawns[us] - 5;
+        int knights = Material::count(key, us, Knight);
+        int rooks = Material::count(key, us, Rook);
+        side.mg += pawnsOverFive * (knights * knightPerPawn.mg + rooks * rookPerPawn.mg);
+        side.eg += pawnsOverFive * (knights * knightPerPawn.eg + rooks * rookPerPawn.eg);
+        if (us == White) {
+            entry.imbalance += side;
+        } else {
+            entry.imbalance -= side;
+        }
+    }
+    return entry;
+}
+
+// -1 when some count is more than the table covers
+static int sideIndex(uint64_t key, ChessColor color)
+{
+    int index = 0;
+    for (int piece = Pawn; piece <= Queen; piece++) {
+        int count = Material::count(key, color, (ChessPiece)piece);
+        if (count > tableLimit[piece]) {
+            return -1;
+        }
+        index = index * (tableLimit[piece] + 1) + count;
+    }
+    return index;
+}
+
+static void fillTable()
+{
+    table.resize(perSide * perSide);
+    // walk every combination of counts, the key is built the same way Position builds it
+    for (int side = 0; side < perSide * perSide; side++) {
+        int rest = side;
+        uint64_t key = 0;
+        for (int color = Black; color >= White; color--) {
+            int index = rest % perSide;
+            rest /= perSide;
+            for (int piece = Queen; piece >= Pawn; piece--) {
+                int count = index % (tableLimit[piece] + 1);
+                index /= tableLimit[piece] + 1;
+                key += count * Material::keyDelta((ChessColor)color, (ChessPiece)piece);
+            }
+        }
+        table[side] = compute(key);
+    }
+}
+
+void Material::init()
+{
+    static std::once_flag once;
+    std::call_once(once, fillTable);
+}
+
+MaterialEntry Material::probe(uint64_t key)
+{
+    int white = sideIndex(key, White);
+    int black = sideIndex(key, Black);
+    if (white < 0 || black < 0) {
+        return compute(key);
+    }
+    return table[white * perSide + black];
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Bitboard.h"
+#include "Evaluation.h"
+#include <cstdint>
+
+// what the pieces on the board say before looking at where they stand
+struct MaterialEntry
+{
+    bool insufficient = false; // no mate is possible: two bare kings, or a single minor piece against a bare king
+    // out of 64, how much of its endgame advantage each side can expect to turn into a win
+    uint8_t scale[2] = { 64, 64 };
+    Score imbalance; // white positive
+};
+
+//
+// The material key packs how many pawns, knights, bishops, rooks and queens each side has, four bits
+// a count, so Position can keep it up to date with one addition per piece that comes or goes.
+// Every ordinary combination (up to eight pawns, two of each minor and rook, one queen a side) is
+// worked out once at init and read from a table, anything stranger is worked out when asked for.
+//
+namespace Material {
+    // fills the table, safe to call more than once
+    void init();
+
+    // what one more piece adds to the material key, kings don't count
+    inline uint64_t keyDelta(ChessColor color, ChessPiece piece)
+    {
+        return piece == King || piece == NoPiece ? 0 : 1ULL << ((color * 5 + piece - Pawn) * 4);
+    }
+    inline int count(uint64_t key, ChessColor color, ChessPiece piece)
+    {
+        return (int)((key >> ((color * 5 + piece - Pawn) * 4)) & 15);
+    }
+
+    MaterialEntry probe(uint64_t key);
+}
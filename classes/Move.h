@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Bitboard.h"
+#include <cstdint>
+#include <string>
+
+enum MoveType {
+    NormalMove = 0,
+    PromotionMove = 1 << 14,
+    EnPassantMove = 2 << 14,
+    CastlingMove = 3 << 14
+};
+
+//
+// a move packed into 16 bits:
+//   bits 0-5   from square
+//   bits 6-11  to square
+//   bits 12-13 promotion piece, Knight..Queen counted from 0
+//   bits 14-15 MoveType
+// castling is stored as the king's move (e1g1), the rook follows along when the move is made.
+// the empty move (all zero, a1a1) can never be a real move, so it doubles as "no move".
+//
+class Move
+{
+public:
+    Move() : _data(0) {}
+    Move(int from, int to) : _data((uint16_t)(from | (to << 6))) {}
+    Move(int from, int to, MoveType type, ChessPiece promotion = Knight)
+        : _data((uint16_t)(from | (to << 6) | ((promotion - Knight) << 12) | type)) {}
+
+    static Move none() { return Move(); }
+    static Move fromRaw(uint16_t data) { Move move; move._data = data; return move; }
+
+    int from() const { return _data & 63; }
+    int to() const { return (_data >> 6) & 63; }
+    MoveType type() const { return (MoveType)(_data & (3 << 14)); }
+    // NoPiece unless this is a promotion
+    ChessPiece promotion() const { return type() == PromotionMove ? (ChessPiece)(((_data >> 12) & 3) + Knight) : NoPiece; }
+    uint16_t raw() const { return _data; }
+
+    bool isNone() const { return _data == 0; }
+    explicit operator bool() const { return _data != 0; }
+    bool operator==(const Move &other) const { return _data == other._data; }
+    bool operator!=(const Move &other) const { return _data != other._data; }
+
+    // long algebraic notation as used by UCI, "e2e4" or "e7e8q"
+    std::string notation() const
+    {
+        if (isNone()) {
+            return "0000";
+        }
+        std::string text = squareNotation(from()) + squareNotation(to());
+        if (type() == PromotionMove) {
+            text += "??nbrq"[promotion()];
+        }
+        return text;
+    }
+
+private:
+    uint16_t _data;
+};
+
+//
+// a fixed size list of moves that lives on the stack, no position has more than 218 legal moves
+//
+const int maxMoves = 256;
+
+class MoveList
+{
+public:
+    MoveList() : _size(0) {}
+
+    void push_back(Move move) { _moves[_size++] = move; }
+    void clear() { _size = 0; }
+
+    int size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    bool contains(Move move) const
+    {
+        for (int i = 0; i < _size; i++) {
+            if (_moves[i] == move) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Move &operator[](int index) { return _moves[index]; }
+    Move operator[](int index) const { return _moves[index]; }
+    Move *begin() { return _moves; }
+    Move *end() { return _moves + _size; }
+    const Move *begin() const { return _moves; }
+    const Move *end() const { return _moves + _size; }
+
+private:
+    Move _moves[maxMoves];
+    int _size;
+};
@@ -0,0 +1,166 @@
+#include "Perft.h"
+#include <algorithm>
+#include <memory>
+
+PerftTable::PerftTable(int megabytes) {
+    _entryCount = std::max<uint64_t>(((uint64_t)megabytes * 1024 * 1024) / sizeof(Entry), 1);
+    _entries = new Entry[_entryCount];
+    clear();
+}
+
+PerftTable::~PerftTable() {
+    delete[] _entries;
+}
+
+void PerftTable::clear() {
+    for (uint64_t i = 0; i < _entryCount; i++) {
+        _entries[i].check.store(0, std::memory_order_relaxed);
+        _entries[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool PerftTable::probe(uint64_t key, int depth, uint64_t &nodes) const {
+    const Entry &entry = entryFor(key);
+    uint64_t data = entry.data.load(std::memory_order_relaxed);
+    if (data && (entry.check.load(std::memory_order_relaxed) ^ data) == key && (int)(data & 0xff) == depth) {
+        nodes = data >> 8;
+        return true;
+    }
+    return false;
+}
+
+void PerftTable::store(uint64_t key, int depth, uint64_t nodes) {
+    Entry &entry = entryFor(key);
+    uint64_t data = nodes << 8 | (uint64_t)depth;
+    entry.data.store(data, std::memory_order_relaxed);
+    entry.check.store(key ^ data, std::memory_order_relaxed);
+}
+
+// counts the tree below the position without threads
+static uint64_t countSerial(Position &position, int depth, PerftTable *table) {
+    MoveList moves;
+    position.generateMoves(moves);
+    if (depth <= 1) {
+        return depth == 1 ? moves.size() : 1;
+    }
+
+    uint64_t nodes = 0;
+    if (table && table->probe(position.key(), depth, nodes)) {
+        return nodes;
+    }
+    for (Move move : moves) {
+        position.makeMove(move);
+        nodes += countSerial(position, depth - 1, table);
+        position.unmakeMove(move);
+    }
+    if (table) {
+        table->store(position.key(), depth, nodes);
+    }
+    return nodes;
+}
+
+//
+// The subtrees a parallel perft shares out. Each job is a root move, or a root move and one reply to it,
+// threads take them one at a time until none are left.
+//
+struct PerftJobs
+{
+    struct Job
+    {
+        int rootIndex;
+        Move reply; // none when the job is the whole root move
+    };
+
+    Position position;
+    MoveList rootMoves;
+    std::vector<Job> jobs;
+    int depth;
+    PerftTable *table;
+    std::atomic<int> nextJob{0};
+    std::unique_ptr<std::atomic<uint64_t>[]> counts; // one per root move
+};
+
+static void countJobs(PerftJobs &jobs) {
+    Position position = jobs.position;
+    while (true) {
+        int index = jobs.nextJob++;
+        if (index >= (int)jobs.jobs.size()) {
+            break;
+        }
+        const PerftJobs::Job &job = jobs.jobs[index];
+        Move move = jobs.rootMoves[job.rootIndex];
+        position.makeMove(move);
+        uint64_t nodes;
+        if (job.reply) {
+            position.makeMove(job.reply);
+            nodes = countSerial(position, jobs.depth - 2, jobs.table);
+            position.unmakeMove(job.reply);
+        } else {
+            nodes = countSerial(position, jobs.depth - 1, jobs.table);
+        }
+        position.unmakeMove(move);
+        jobs.counts[job.rootIndex] += nodes;
+    }
+}
+
+static std::vector<PerftDivide> divideParallel(Position &position, int depth, PerftTable *table, ThreadPool &pool, bool splitReplies) {
+    auto jobs = std::make_shared<PerftJobs>();
+    jobs->position = position;
+    jobs->depth = depth;
+    jobs->table = table;
+    position.generateMoves(jobs->rootMoves);
+    jobs->counts = std::make_unique<std::atomic<uint64_t>[]>(jobs->rootMoves.size());
+    for (int i = 0; i < jobs->rootMoves.size(); i++) {
+        jobs->counts[i] = 0;
+        Move move = jobs->rootMoves[i];
+        if (!splitReplies || depth < 3) {
+            jobs->jobs.push_back({i, Move::none()});
+            continue;
+        }
+        position.makeMove(move);
+        MoveList replies;
+        position.generateMoves(replies);
+        for (Move reply : replies) {
+            jobs->jobs.push_back({i, reply});
+        }
+        position.unmakeMove(move);
+    }
+
+    pool.runShared((int)jobs->jobs.size() - 1, [jobs] {
+        countJobs(*jobs);
+    }, [&jobs] {
+        countJobs(*jobs);
+    });
+
+    std::vector<PerftDivide> counts;
+    for (int i = 0; i < jobs->rootMoves.size(); i++) {
+        counts.push_back({jobs->rootMoves[i], jobs->counts[i].load()});
+    }
+    return counts;
+}
+
+uint64_t Perft::count(Position &position, int depth, PerftTable *table, ThreadPool *pool, bool splitReplies) {
+    if (!pool || depth < 2) {
+        return countSerial(position, depth, table);
+    }
+    uint64_t nodes = 0;
+    for (const PerftDivide &root : divideParallel(position, depth, table, *pool, splitReplies)) {
+        nodes += root.nodes;
+    }
+    return nodes;
+}
+
+std::vector<PerftDivide> Perft::divide(Position &position, int depth, PerftTable *table, ThreadPool *pool, bool splitReplies) {
+    if (pool) {
+        return divideParallel(position, depth, table, *pool, splitReplies);
+    }
+    MoveList moves;
+    position.generateMoves(moves);
+    std::vector<PerftDivide> counts;
+    for (Move move : moves) {
+        position.makeMove(move);
+        counts.push_back({move, countSerial(position, depth - 1, table)});
+        position.unmakeMove(move);
+    }
+    return counts;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Position.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+//
+// Subtree counts remembered by key and depth, so a position reached by different move orders is only counted once.
+// Like the transposition table an entry is the packed data and the key xor'ed with it, so it needs no locks.
+//
+class PerftTable
+{
+public:
+    explicit PerftTable(int megabytes);
+    ~PerftTable();
+
+    void clear();
+
+    bool probe(uint64_t key, int depth, uint64_t &nodes) const;
+    void store(uint64_t key, int depth, uint64_t nodes);
+
+private:
+    struct Entry
+    {
+        std::atomic<uint64_t> check; // key ^ data
+        std::atomic<uint64_t> data;  // nodes << 8 | depth
+    };
+
+    Entry &entryFor(uint64_t key) const { return _entries[((key >> 32) * _entryCount) >> 32]; }
+
+    Entry *_entries;
+    uint64_t _entryCount;
+};
+
+// how many leaves one root move leads to
+struct PerftDivide
+{
+    Move move;
+    uint64_t nodes;
+};
+
+//
+// Perft counts the leaves of the legal move tree to a fixed depth, which checks the move generator against known
+// counts and times it. The last ply isn't played out, the number of legal moves there is its count (bulk counting).
+// Given a pool the root moves, or with splitReplies every reply to them, are shared out over its workers
+// and the calling thread, each counting on its own copy of the position. They may share one table.
+//
+namespace Perft {
+    uint64_t count(Position &position, int depth, PerftTable *table = nullptr, ThreadPool *pool = nullptr, bool splitReplies = false);
+    // the count split up by root move, in generator order
+    std::vector<PerftDivide> divide(Position &position, int depth, PerftTable *table = nullptr, ThreadPool *pool = nullptr,
+                                    bool splitReplies = false);
+}
@@ -0,0 +1,523 @@
+#include "Position.h"
+#include <cctype>
+#include <sstream>
+
+// castling rights that survive a piece moving from or to each square
+static int castlingMask(int square)
+{
+    switch (square) {
+        case A1: return AllCastling & ~WhiteQueenSide;
+        case E1: return AllCastling & ~(WhiteKingSide | WhiteQueenSide);
+        case H1: return AllCastling & ~WhiteKingSide;
+        case A8: return AllCastling & ~BlackQueenSide;
+        case E8: return AllCastling & ~(BlackKingSide | BlackQueenSide);
+        case H8: return AllCastling & ~BlackKingSide;
+        default: return AllCastling;
+    }
+}
+
+Position::Position() {
+    Bitboards::init();
+    Zobrist::init();
+    Evaluation::init();
+    Material::init();
+    clear();
+}
+
+void Position::clear() {
+    for (int color = 0; color < 2; color++) {
+        for (int piece = 0; piece < 7; piece++) {
+            _pieces[color][piece] = 0;
+        }
+    }
+    for (int square = 0; square < 64; square++) {
+        _board[square] = 0;
+    }
+    _sideToMove = White;
+    _castlingRights = NoCastling;
+    _enPassantSquare = NoSquare;
+    _halfmoveClock = 0;
+    _fullmoveNumber = 1;
+    _stateIndex = 0;
+    _psqScore = Score();
+    _phase = 0;
+    _key = 0;
+    _pawnKey = 0;
+    _materialKey = 0;
+}
+
+bool Position::setFromFEN(const std::string &fen) {
+    static const std::string pieceChars = " PNBRQK";
+
+    std::istringstream fenStream(fen);
+    std::string placement, side, castling, enPassant;
+    fenStream >> placement >> side >> castling >> enPassant;
+
+    clear();
+    int row = 7; // fen starts with the 8th rank
+    int column = 0;
+    for (char ch : placement) {
+        if (ch == '/') {
+            row--;
+            column = 0;
+        } else if (isdigit(ch)) {
+            column += ch - '0';
+        } else {
+            size_t piece = pieceChars.find((char)toupper(ch));
+            if (piece == std::string::npos || piece == 0 || row < 0 || column > 7) {
+                clear();
+                return false;
+            }
+            putPiece(makeSquare(row, column), isupper(ch) ? White : Black, (ChessPiece)piece);
+            column++;
+        }
+    }
+
+    _sideToMove = (side == "b") ? Black : White;
+    for (char ch : castling) {
+        switch (ch) {
+            case 'K': _castlingRights |= WhiteKingSide; break;
+            case 'Q': _castlingRights |= WhiteQueenSide; break;
+            case 'k': _castlingRights |= BlackKingSide; break;
+            case 'q': _castlingRights |= BlackQueenSide; break;
+        }
+    }
+    _castlingRights = possibleCastlingRights(_castlingRights);
+    _enPassantSquare = notationSquare(enPassant);
+    if (_enPassantSquare != NoSquare && !canCaptureEnPassant(_enPassantSquare, _sideToMove)) {
+        _enPassantSquare = NoSquare;
+    }
+    if (!(fenStream >> _halfmoveClock)) {
+        _halfmoveClock = 0;
+    }
+    if (!(fenStream >> _fullmoveNumber)) {
+        _fullmoveNumber = 1;
+    }
+    _key = computeKey();
+    return true;
+}
+
+int Position::possibleCastlingRights(int rights) const {
+    static const int homes[2][3] = {{A1, E1, H1}, {A8, E8, H8}};
+    for (int color = White; color <= Black; color++) {
+        for (int square : homes[color]) {
+            ChessPiece piece = squareColumn(square) == 4 ? King : Rook;
+            if (isEmpty(square) || pieceAt(square) != piece || colorAt(square) != color) {
+                rights &= castlingMask(square);
+            }
+        }
+    }
+    return rights;
+}
+
+uint64_t Position::computeKey() const {
+    uint64_t key = 0;
+    for (int square = 0; square < 64; square++) {
+        if (!isEmpty(square)) {
+            key ^= Zobrist::pieceSquare[colorAt(square)][pieceAt(square)][square];
+        }
+    }
+    key ^= Zobrist::castling[_castlingRights];
+    if (_enPassantSquare != NoSquare) {
+        key ^= Zobrist::enPassantFile[squareColumn(_enPassantSquare)];
+    }
+    if (_sideToMove == Black) {
+        key ^= Zobrist::blackToMove;
+    }
+    return key;
+}
+
+void Position::setSideToMove(ChessColor color) {
+    _sideToMove = color;
+    _key = computeKey();
+}
+
+void Position::setCastlingRights(int rights) {
+    _castlingRights = possibleCastlingRights(rights);
+    _key = computeKey();
+}
+
+void Position::setEnPassantSquare(int square) {
+    _enPassantSquare = (square != NoSquare && canCaptureEnPassant(square, _sideToMove)) ? square : NoSquare;
+    _key = computeKey();
+}
+
+bool Position::canCaptureEnPassant(int square, ChessColor byColor) const {
+    return (Bitboards::pawnAttacks(oppositeColor(byColor), square) & pieces(byColor, Pawn)) != 0;
+}
+
+bool Position::isRepetition() const {
+    int limit = _halfmoveClock < _stateIndex ? _halfmoveClock : _stateIndex;
+    // only positions with the same side to move can repeat, so step back two plies at a time
+    for (int back = 4; back <= limit; back += 2) {
+        if (_states[_stateIndex - back].key == _key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string Position::toFEN() const {
+    static const char *pieceChars = " PNBRQK";
+    std::string fen;
+    for (int row = 7; row >= 0; row--) {
+        int empty = 0;
+        for (int column = 0; column < 8; column++) {
+            int square = makeSquare(row, column);
+            if (isEmpty(square)) {
+                empty++;
+                continue;
+            }
+            if (empty) {
+                fen += (char)('0' + empty);
+                empty = 0;
+            }
+            char ch = pieceChars[pieceAt(square)];
+            fen += colorAt(square) == White ? ch : (char)tolower(ch);
+        }
+        if (empty) {
+            fen += (char)('0' + empty);
+        }
+        if (row > 0) {
+            fen += '/';
+        }
+    }
+    fen += _sideToMove == White ? " w " : " b ";
+    if (_castlingRights == NoCastling) {
+        fen += "-";
+    }
+    if (_castlingRights & WhiteKingSide) fen += "K";
+    if (_castlingRights & WhiteQueenSide) fen += "Q";
+    if (_castlingRights & BlackKingSide) fen += "k";
+    if (_castlingRights & BlackQueenSide) fen += "q";
+    fen += " " + squareNotation(_enPassantSquare);
+    fen += " " + std::to_string(_halfmoveClock) + " " + std::to_string(_fullmoveNumber);
+    return fen;
+}
+
+void Position::putPiece(int square, ChessColor color, ChessPiece piece) {
+    Bitboard bit = squareBit(square);
+    _pieces[color][piece] |= bit;
+    _pieces[color][NoPiece] |= bit;
+    _board[square] = (unsigned char)(piece | (color << 3));
+    _key ^= Zobrist::pieceSquare[color][piece][square];
+    if (piece == Pawn) {
+        _pawnKey ^= Zobrist::pieceSquare[color][Pawn][square];
+    }
+    _materialKey += Material::keyDelta(color, piece);
+    _psqScore += Evaluation::pieceSquare[color][piece][square];
+    _phase += Evaluation::phaseWeight[piece];
+}
+
+void Position::removePiece(int square) {
+    if (isEmpty(square)) {
+        return;
+    }
+    Bitboard bit = squareBit(square);
+    ChessColor color = colorAt(square);
+    _key ^= Zobrist::pieceSquare[color][pieceAt(square)][square];
+    if (pieceAt(square) == Pawn) {
+        _pawnKey ^= Zobrist::pieceSquare[color][Pawn][square];
+    }
+    _materialKey -= Material::keyDelta(color, pieceAt(square));
+    _psqScore -= Evaluation::pieceSquare[color][pieceAt(square)][square];
+    _phase -= Evaluation::phaseWeight[pieceAt(square)];
+    _pieces[color][pieceAt(square)] &= ~bit;
+    _pieces[color][NoPiece] &= ~bit;
+    _board[square] = 0;
+}
+
+Bitboard Position::attackersTo(int square, Bitboard occupied) const {
+    Bitboard bishops = _pieces[White][Bishop] | _pieces[Black][Bishop] | _pieces[White][Queen] | _pieces[Black][Queen];
+    Bitboard rooks = _pieces[White][Rook] | _pieces[Black][Rook] | _pieces[White][Queen] | _pieces[Black][Queen];
+    return (Bitboards::pawnAttacks(Black, square) & _pieces[White][Pawn])
+         | (Bitboards::pawnAttacks(White, square) & _pieces[Black][Pawn])
+         | (Bitboards::knightAttacks(square) & (_pieces[White][Knight] | _pieces[Black][Knight]))
+         | (Bitboards::kingAttacks(square) & (_pieces[White][King] | _pieces[Black][King]))
+         | (Bitboards::bishopAttacks(square, occupied) & bishops)
+         | (Bitboards::rookAttacks(square, occupied) & rooks);
+}
+
+bool Position::isSquareAttacked(int square, ChessColor byColor) const {
+    return (attackersTo(square, occupied()) & pieces(byColor)) != 0;
+}
+
+bool Position::inCheck() const {
+    int king = kingSquare(_sideToMove);
+    return king != NoSquare && isSquareAttacked(king, oppositeColor(_sideToMove));
+}
+
+void Position::addPawnMoves(MoveList &moves, int from, int to, bool queenOnly) const {
+    if (squareBit(to) & (row1Bits | row8Bits)) {
+        moves.push_back(Move(from, to, PromotionMove, Queen));
+        if (queenOnly) {
+            return;
+        }
+        moves.push_back(Move(from, to, PromotionMove, Rook));
+        moves.push_back(Move(from, to, PromotionMove, Bishop));
+        moves.push_back(Move(from, to, PromotionMove, Knight));
+    } else {
+        moves.push_back(Move(from, to));
+    }
+}
+
+Bitboard Position::pinnedPieces(ChessColor color) const {
+    int king = kingSquare(color);
+    if (king == NoSquare) {
+        return 0;
+    }
+    ChessColor them = oppositeColor(color);
+    Bitboard occupiedBits = occupied();
+    Bitboard snipers = (Bitboards::rookAttacks(king, 0) & (pieces(them, Rook) | pieces(them, Queen)))
+                     | (Bitboards::bishopAttacks(king, 0) & (pieces(them, Bishop) | pieces(them, Queen)));
+    Bitboard pinned = 0;
+    while (snipers) {
+        Bitboard blockers = Bitboards::betweenBits(king, popLsb(snipers)) & occupiedBits;
+        if (popCount(blockers) == 1) {
+            pinned |= blockers & pieces(color);
+        }
+    }
+    return pinned;
+}
+
+// an en passant capture takes two pawns off the same row at once, so check what the king sees afterwards
+bool Position::enPassantIsLegal(int from) const {
+    ChessColor us = _sideToMove;
+    ChessColor them = oppositeColor(us);
+    int king = kingSquare(us);
+    if (king == NoSquare) {
+        return true;
+    }
+    int captured = _enPassantSquare + (us == White ? -8 : 8);
+    Bitboard after = (occupied() ^ squareBit(from) ^ squareBit(captured)) | squareBit(_enPassantSquare);
+    Bitboard attackers = (Bitboards::rookAttacks(king, after) & (pieces(them, Rook) | pieces(them, Queen)))
+                       | (Bitboards::bishopAttacks(king, after) & (pieces(them, Bishop) | pieces(them, Queen)))
+                       | (Bitboards::knightAttacks(king) & pieces(them, Knight))
+                       | (Bitboards::pawnAttacks(us, king) & pieces(them, Pawn) & ~squareBit(captured));
+    return attackers == 0;
+}
+
+//
+// Only legal moves come out of here. Checkers and pinned pieces are worked out once:
+// the king steps to squares nothing attacks, in double check nothing else may move,
+// in single check the other pieces have to take the checker or block it,
+// and a pinned piece can only slide along the line between its king and the pinner.
+// capturesOnly keeps just the moves that take something, plus pushes to the last row as a queen.
+//
+void Position::generateMoves(MoveList &moves) const {
+    generate(moves, false);
+}
+
+void Position::generateCaptures(MoveList &moves) const {
+    generate(moves, true);
+}
+
+void Position::generate(MoveList &moves, bool capturesOnly) const {
+    moves.clear();
+    ChessColor us = _sideToMove;
+    ChessColor them = oppositeColor(us);
+    Bitboard occupiedBits = occupied();
+    Bitboard ours = pieces(us);
+    int king = kingSquare(us);
+
+    Bitboard checkers = 0;
+    Bitboard pinned = 0;
+    if (king != NoSquare) {
+        checkers = attackersTo(king, occupiedBits) & pieces(them);
+        pinned = pinnedPieces(us);
+
+        // take the king off the board so it can't hide behind itself from a slider
+        Bitboard withoutKing = occupiedBits ^ squareBit(king);
+        Bitboard kingMoves = Bitboards::kingAttacks(king) & (capturesOnly ? pieces(them) : ~ours);
+        while (kingMoves) {
+            int to = popLsb(kingMoves);
+            if (!(attackersTo(to, withoutKing) & pieces(them))) {
+                moves.push_back(Move(king, to));
+            }
+        }
+        if (popCount(checkers) > 1) {
+            return;
+        }
+    }
+
+    Bitboard targets = ~ours;
+    if (checkers) {
+        targets &= checkers | Bitboards::betweenBits(king, lsb(checkers));
+    }
+    // pawns may still push onto the last row, everything else has to take a piece
+    Bitboard pawnTargets = capturesOnly ? targets & (pieces(them) | row1Bits | row8Bits) : targets;
+    if (capturesOnly) {
+        targets &= pieces(them);
+    }
+
+    // pawns
+    int forward = (us == White) ? 8 : -8;
+    int startRow = (us == White) ? 1 : 6;
+    Bitboard pawns = pieces(us, Pawn);
+    while (pawns) {
+        int from = popLsb(pawns);
+        Bitboard allowed = (pinned & squareBit(from)) ? pawnTargets & Bitboards::lineBits(king, from) : pawnTargets;
+        Bitboard destinations = Bitboards::pawnAttacks(us, from) & pieces(them);
+        int to = from + forward;
+        if (!(occupiedBits & squareBit(to))) {
+            destinations |= squareBit(to);
+            if (squareRow(from) == startRow && !(occupiedBits & squareBit(to + forward))) {
+                destinations |= squareBit(to + forward);
+            }
+        }
+        destinations &= allowed;
+        while (destinations) {
+            addPawnMoves(moves, from, popLsb(destinations), capturesOnly);
+        }
+        if (_enPassantSquare != NoSquare && (Bitboards::pawnAttacks(us, from) & squareBit(_enPassantSquare)) && enPassantIsLegal(from)) {
+            moves.push_back(Move(from, _enPassantSquare, EnPassantMove));
+        }
+    }
+
+    // knights and sliders, a pinned knight can never move
+    for (int piece = Knight; piece <= Queen; piece++) {
+        Bitboard movers = pieces(us, (ChessPiece)piece);
+        if (piece == Knight) {
+            movers &= ~pinned;
+        }
+        while (movers) {
+            int from = popLsb(movers);
+            Bitboard attacks = 0;
+            switch (piece) {
+                case Knight: attacks = Bitboards::knightAttacks(from); break;
+                case Bishop: attacks = Bitboards::bishopAttacks(from, occupiedBits); break;
+                case Rook: attacks = Bitboards::rookAttacks(from, occupiedBits); break;
+                case Queen: attacks = Bitboards::queenAttacks(from, occupiedBits); break;
+            }
+            attacks &= targets;
+            if (pinned & squareBit(from)) {
+                attacks &= Bitboards::lineBits(king, from);
+            }
+            while (attacks) {
+                moves.push_back(Move(from, popLsb(attacks)));
+            }
+        }
+    }
+
+    if (capturesOnly) {
+        return;
+    }
+
+    // castling, the king may not start in, pass through or land in check
+    int kingRights = (us == White) ? WhiteKingSide : BlackKingSide;
+    int queenRights = (us == White) ? WhiteQueenSide : BlackQueenSide;
+    int home = (us == White) ? E1 : E8;
+    if (!checkers && king == home && (_castlingRights & (kingRights | queenRights))) {
+        if ((_castlingRights & kingRights) && isEmpty(home + 1) && isEmpty(home + 2) &&
+            !isSquareAttacked(home + 1, them) && !isSquareAttacked(home + 2, them)) {
+            moves.push_back(Move(home, home + 2, CastlingMove));
+        }
+        if ((_castlingRights & queenRights) && isEmpty(home - 1) && isEmpty(home - 2) && isEmpty(home - 3) &&
+            !isSquareAttacked(home - 1, them) && !isSquareAttacked(home - 2, them)) {
+            moves.push_back(Move(home, home - 2, CastlingMove));
+        }
+    }
+}
+
+void Position::makeMove(Move move) {
+    ChessColor us = _sideToMove;
+    int from = move.from();
+    int to = move.to();
+    ChessPiece piece = pieceAt(from);
+
+    StateInfo &state = _states[_stateIndex++];
+    state.castlingRights = _castlingRights;
+    state.enPassantSquare = _enPassantSquare;
+    state.halfmoveClock = _halfmoveClock;
+    state.captured = move.type() == EnPassantMove ? Pawn : (isEmpty(to) ? NoPiece : pieceAt(to));
+    state.key = _key;
+
+    if (move.type() == EnPassantMove) {
+        // the captured pawn sits behind the square we moved to
+        removePiece(to + (us == White ? -8 : 8));
+    } else if (move.type() == CastlingMove) {
+        // bring the rook over the king
+        int rookFrom = to > from ? from + 3 : from - 4;
+        int rookTo = (from + to) / 2;
+        removePiece(rookFrom);
+        putPiece(rookTo, us, Rook);
+    }
+    removePiece(to);
+    removePiece(from);
+    putPiece(to, us, move.type() == PromotionMove ? move.promotion() : piece);
+
+    if (_enPassantSquare != NoSquare) {
+        _key ^= Zobrist::enPassantFile[squareColumn(_enPassantSquare)];
+        _enPassantSquare = NoSquare;
+    }
+    if (piece == Pawn && (to - from == 16 || from - to == 16) && canCaptureEnPassant((from + to) / 2, oppositeColor(us))) {
+        _enPassantSquare = (from + to) / 2;
+        _key ^= Zobrist::enPassantFile[squareColumn(_enPassantSquare)];
+    }
+    _key ^= Zobrist::castling[_castlingRights];
+    _castlingRights &= castlingMask(from) & castlingMask(to);
+    _key ^= Zobrist::castling[_castlingRights];
+    _halfmoveClock = (piece == Pawn || state.captured != NoPiece) ? 0 : _halfmoveClock + 1;
+    if (us == Black) {
+        _fullmoveNumber++;
+    }
+    _sideToMove = oppositeColor(us);
+    _key ^= Zobrist::blackToMove;
+}
+
+void Position::makeNullMove() {
+    StateInfo &state = _states[_stateIndex++];
+    state.castlingRights = _castlingRights;
+    state.enPassantSquare = _enPassantSquare;
+    state.halfmoveClock = _halfmoveClock;
+    state.captured = NoPiece;
+    state.key = _key;
+
+    if (_enPassantSquare != NoSquare) {
+        _key ^= Zobrist::enPassantFile[squareColumn(_enPassantSquare)];
+        _enPassantSquare = NoSquare;
+    }
+    // nothing before a null move counts as a repetition of what comes after it
+    _halfmoveClock = 0;
+    _sideToMove = oppositeColor(_sideToMove);
+    _key ^= Zobrist::blackToMove;
+}
+
+void Position::unmakeNullMove() {
+    const StateInfo &state = _states[--_stateIndex];
+    _enPassantSquare = state.enPassantSquare;
+    _halfmoveClock = state.halfmoveClock;
+    _key = state.key;
+    _sideToMove = oppositeColor(_sideToMove);
+}
+
+void Position::unmakeMove(Move move) {
+    ChessColor us = oppositeColor(_sideToMove);
+    ChessColor them = _sideToMove;
+    int from = move.from();
+    int to = move.to();
+    const StateInfo &state = _states[--_stateIndex];
+
+    ChessPiece piece = move.type() == PromotionMove ? Pawn : pieceAt(to);
+    removePiece(to);
+    putPiece(from, us, piece);
+    if (move.type() == EnPassantMove) {
+        putPiece(to + (us == White ? -8 : 8), them, Pawn);
+    } else if (move.type() == CastlingMove) {
+        int rookFrom = to > from ? from + 3 : from - 4;
+        int rookTo = (from + to) / 2;
+        removePiece(rookTo);
+        putPiece(rookFrom, us, Rook);
+    } else if (state.captured != NoPiece) {
+        putPiece(to, them, state.captured);
+    }
+
+    _castlingRights = state.castlingRights;
+    _enPassantSquare = state.enPassantSquare;
+    _halfmoveClock = state.halfmoveClock;
+    _key = state.key;
+    if (us == Black) {
+        _fullmoveNumber--;
+    }
+    _sideToMove = us;
+}
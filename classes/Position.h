@@ -0,0 +1,137 @@
+#pragma once
+
+#include "Bitboard.h"
+#include "Evaluation.h"
+#include "Material.h"
+#include "Move.h"
+#include "Zobrist.h"
+#include <string>
+
+//
+// Position is the board the engine thinks on. It knows nothing about sprites or ImGui,
+// Chess keeps one in step with the game and only copies it onto its ChessSquare grid for drawing.
+//
+
+enum CastlingRights {
+    NoCastling = 0,
+    WhiteKingSide = 1,
+    WhiteQueenSide = 2,
+    BlackKingSide = 4,
+    BlackQueenSide = 8,
+    AllCastling = 15
+};
+
+const char *const startPositionFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// room for a long game plus a search on top of it
+const int maxGamePlies = 1024;
+const int maxSearchPly = 128;
+
+// what makeMove can't work out backwards, saved so unmakeMove can put it back
+struct StateInfo
+{
+    int castlingRights;
+    int enPassantSquare;
+    int halfmoveClock;
+    ChessPiece captured;
+    uint64_t key;
+};
+
+class Position
+{
+public:
+    Position();
+
+    void clear();
+    // returns false if the placement part of the fen can't be read, missing fields get their defaults
+    bool setFromFEN(const std::string &fen);
+    std::string toFEN() const;
+
+    void putPiece(int square, ChessColor color, ChessPiece piece);
+    void removePiece(int square);
+
+    ChessPiece pieceAt(int square) const { return (ChessPiece)(_board[square] & 7); }
+    ChessColor colorAt(int square) const { return (ChessColor)(_board[square] >> 3); }
+    bool isEmpty(int square) const { return _board[square] == 0; }
+
+    // pieces(color) is every piece of that color
+    Bitboard pieces(ChessColor color) const { return _pieces[color][NoPiece]; }
+    Bitboard pieces(ChessColor color, ChessPiece piece) const { return _pieces[color][piece]; }
+    Bitboard occupied() const { return _pieces[White][NoPiece] | _pieces[Black][NoPiece]; }
+    // NoSquare if that side has no king
+    int kingSquare(ChessColor color) const { return _pieces[color][King] ? lsb(_pieces[color][King]) : NoSquare; }
+
+    ChessColor sideToMove() const { return _sideToMove; }
+    void setSideToMove(ChessColor color);
+    int castlingRights() const { return _castlingRights; }
+    // rights whose king or rook isn't at home are dropped, as they are when reading a fen
+    void setCastlingRights(int rights);
+    // only set when a pawn can actually take en passant, so equal positions always get equal keys
+    int enPassantSquare() const { return _enPassantSquare; }
+    void setEnPassantSquare(int square);
+    int halfmoveClock() const { return _halfmoveClock; }
+    int fullmoveNumber() const { return _fullmoveNumber; }
+
+    Bitboard attackersTo(int square, Bitboard occupied) const;
+    bool isSquareAttacked(int square, ChessColor byColor) const;
+    bool inCheck() const;
+
+    // Zobrist key of pieces, side to move, castling rights and en passant file, kept up to date by every change
+    uint64_t key() const { return _key; }
+    // Zobrist key of the pawns alone, for the pawn structure cache
+    uint64_t pawnKey() const { return _pawnKey; }
+    // piece counts of both sides packed together, see Material
+    uint64_t materialKey() const { return _materialKey; }
+    // sum of the piece-square scores of every piece, white positive, kept up to date like the key
+    Score psqScore() const { return _psqScore; }
+    // sum of Evaluation::phaseWeight over the pieces left
+    int phase() const { return _phase; }
+    // has this position been seen before since the last capture or pawn move
+    bool isRepetition() const;
+
+    // every legal move for the side to move
+    void generateMoves(MoveList &moves) const;
+    // the legal captures and queen promotions only, what the quiescence search looks at
+    void generateCaptures(MoveList &moves) const;
+    // does the move take a piece, en passant included. only meaningful before the move is made
+    bool isCapture(Move move) const { return !isEmpty(move.to()) || move.type() == EnPassantMove; }
+    // the piece a move takes, NoPiece for a quiet move
+    ChessPiece capturedPiece(Move move) const { return move.type() == EnPassantMove ? Pawn : pieceAt(move.to()); }
+    // plays a move produced by generateMoves, unmakeMove takes back the last one made
+    void makeMove(Move move);
+    void unmakeMove(Move move);
+    // passes the turn without moving, for null move pruning. never called while in check
+    void makeNullMove();
+    void unmakeNullMove();
+    // how many moves can be taken back
+    int historyLength() const { return _stateIndex; }
+    // forget the saved states, the current position stays as it is
+    void clearHistory() { _stateIndex = 0; }
+
+private:
+    // pieces of color that can't leave the line between their king and an enemy slider
+    Bitboard pinnedPieces(ChessColor color) const;
+    bool enPassantIsLegal(int from) const;
+    bool canCaptureEnPassant(int square, ChessColor byColor) const;
+    uint64_t computeKey() const;
+    // rights with every right whose king or rook has left its home square taken out
+    int possibleCastlingRights(int rights) const;
+    void generate(MoveList &moves, bool capturesOnly) const;
+    void addPawnMoves(MoveList &moves, int from, int to, bool queenOnly) const;
+
+    Bitboard _pieces[2][7];
+    unsigned char _board[64]; // piece | color << 3, 0 for an empty square
+    ChessColor _sideToMove;
+    int _castlingRights;
+    int _enPassantSquare;
+    int _halfmoveClock;
+    int _fullmoveNumber;
+    uint64_t _key;
+    uint64_t _pawnKey;
+    uint64_t _materialKey;
+    Score _psqScore;
+    int _phase;
+
+    StateInfo _states[maxGamePlies + maxSearchPly];
+    int _stateIndex;
+};
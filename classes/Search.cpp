@@ -0,0 +1,586 @@
+#include "Search.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+static const int infiniteScore = mateScore + 1;
+// rough piece values for ordering captures and delta pruning, the evaluation has its own
+static const int pieceScores[] = { 0, 100, 300, 300, 500, 900, 2000 };
+
+// sort keys for move ordering, each group stays above the next one
+static const int hashMoveScore = 1 << 30;
+static const int captureScore = 1 << 28;
+static const int killerScore = 1 << 27;
+// a capture that can't lift the score to within this of alpha even with the piece it takes is skipped
+static const int deltaMargin = 200;
+// aspiration windows start this wide around the last score, from this depth on, and grow on every fail
+static const int aspirationWindow = 25;
+static const int aspirationDepth = 4;
+// null move pruning needs this much depth left, and skips 2 plies plus one more every 4 of depth
+static const int nullMoveDepth = 3;
+// late moves are reduced from this depth on, after this many moves have been tried
+static const int reductionDepth = 3;
+static const int reductionMoves = 3;
+// only nodes with at least this much depth left are shared out, anything smaller isn't worth the copying
+static const int splitDepth = 4;
+// history is halved once it reaches this, quiet moves always stay below the killers
+static const int historyLimit = 1 << 20;
+
+// plies to take off a late quiet move, by depth left and how many moves came before it.
+// grows slowly with both, a bad move ordered late at high depth loses the most
+static int reductions[maxSearchPly][maxMoves];
+static std::once_flag reductionsInitialized;
+
+static void initReductions() {
+    for (int depth = 1; depth < maxSearchPly; depth++) {
+        for (int moveNumber = 1; moveNumber < maxMoves; moveNumber++) {
+            reductions[depth][moveNumber] = (int)(0.75 + std::log(depth) * std::log(moveNumber) / 2.25);
+        }
+    }
+}
+
+//
+// Everything the threads working on one node share. The owner searches the eldest move alone,
+// then it and any helpers take the remaining moves one at a time until they run out or one cuts off.
+// Helpers copy the position as it was before any move, the owner waits until every helper that
+// joined has left before it reads the result.
+//
+struct SplitPoint
+{
+    const SplitPoint *parent;
+    Position position;
+    MoveList moves;
+    int depth;
+    int ply;
+    int beta;
+    bool inCheck;
+    std::atomic<int> nextMove;
+    std::atomic<int> alpha;
+    std::atomic<bool> cutoff;
+
+    std::mutex mutex; // guards the best move and score
+    int bestScore;
+    Move bestMove;
+};
+
+Search::Search(TranspositionTable &transpositionTable, SearchSignals &signals, int threadIndex)
+    : _transpositionTable(transpositionTable), _signals(signals), _threadIndex(threadIndex), _nodes(0),
+      _pool(nullptr), _splitPoint(nullptr), _splits(0), _helpedMoves(0) {
+    std::call_once(reductionsInitialized, initReductions);
+    clear();
+}
+
+void Search::clear() {
+    std::fill(&_history[0][0][0], &_history[0][0][0] + 2 * 64 * 64, 0);
+}
+
+void Search::setSplitting(ThreadPool *pool, const std::vector<Search *> &workers) {
+    _pool = pool;
+    _workers = workers;
+}
+
+void Search::resetStats() {
+    _nodes = 0;
+    _splits = 0;
+    _helpedMoves = 0;
+}
+
+bool Search::aborted() const {
+    if (_signals.stop.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    for (const SplitPoint *splitPoint = _splitPoint; splitPoint; splitPoint = splitPoint->parent) {
+        if (splitPoint->cutoff.load(std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int64_t Search::clockMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int Search::elapsedMs() const {
+    return (int)(clockMs() - _signals.clockStartMs.load(std::memory_order_acquire));
+}
+
+// how many nodes a thread searches between adding them to the shared count and checking the limits
+static const uint64_t nodeBatch = 1024;
+
+void Search::checkLimits() {
+    if (_nodes % nodeBatch != 0) {
+        return;
+    }
+    uint64_t nodes = _signals.nodes.fetch_add(nodeBatch, std::memory_order_relaxed) + nodeBatch;
+    if (_signals.pondering.load(std::memory_order_acquire)) {
+        return;
+    }
+    if ((_limits.maxNodes > 0 && nodes >= _limits.maxNodes) ||
+        (_threadIndex == 0 && _limits.moveTimeMs > 0 && elapsedMs() >= _limits.moveTimeMs)) {
+        stop();
+    }
+}
+
+uint64_t Search::totalNodes() const {
+    return _signals.nodes.load(std::memory_order_relaxed) + _nodes % nodeBatch;
+}
+
+int Search::evaluate() {
+    return Evaluation::evaluate(_position, _pawnTable);
+}
+
+void Search::scoreMoves(const MoveList &moves, int *scores, Move hashMove, int ply) const {
+    ChessColor color = _position.sideToMove();
+    for (int i = 0; i < moves.size(); i++) {
+        Move move = moves[i];
+        if (move == hashMove) {
+            scores[i] = hashMoveScore;
+        } else if (_position.isCapture(move) || move.promotion() == Queen) {
+            // most valuable victim first, cheapest attacker breaks the tie
+            scores[i] = captureScore + pieceScores[_position.capturedPiece(move)] * 8 + pieceScores[move.promotion()] * 8 - _position.pieceAt(move.from());
+        } else if (move == _killers[ply][0]) {
+            scores[i] = killerScore + 1;
+        } else if (move == _killers[ply][1]) {
+            scores[i] = killerScore;
+        } else {
+            scores[i] = _history[color][move.from()][move.to()];
+        }
+    }
+}
+
+Move Search::pickMove(MoveList &moves, int *scores, int index) const {
+    int best = index;
+    for (int i = index + 1; i < moves.size(); i++) {
+        if (scores[i] > scores[best]) {
+            best = i;
+        }
+    }
+    std::swap(moves[index], moves[best]);
+    std::swap(scores[index], scores[best]);
+    return moves[index];
+}
+
+void Search::updateQuietStats(Move move, int depth, int ply) {
+    if (_killers[ply][0] != move) {
+        _killers[ply][1] = _killers[ply][0];
+        _killers[ply][0] = move;
+    }
+    int &history = _history[_position.sideToMove()][move.from()][move.to()];
+    history += depth * depth;
+    if (history >= historyLimit) {
+        // keep the table from saturating, old cutoffs count for less than new ones
+        for (auto &bySquare : _history) {
+            for (auto &byTarget : bySquare) {
+                for (int &value : byTarget) {
+                    value /= 2;
+                }
+            }
+        }
+    }
+}
+
+SearchResult Search::think(const Position &position, const SearchLimits &limits) {
+    _position = position;
+    _limits = limits;
+    _nodes = 0;
+    _splitPoint = nullptr;
+    for (auto &killers : _killers) {
+        killers[0] = killers[1] = Move::none();
+    }
+
+    SearchResult result;
+    _position.generateMoves(_rootMoves);
+    if (_rootMoves.empty()) {
+        return result;
+    }
+    // the first iteration sees the root in the same order as any other node
+    int rootScores[maxMoves];
+    TTData stored;
+    Move hashMove = _transpositionTable.probe(_position.key(), stored) ? stored.move : Move::none();
+    scoreMoves(_rootMoves, rootScores, hashMove, 0);
+    for (int i = 0; i < _rootMoves.size(); i++) {
+        pickMove(_rootMoves, rootScores, i);
+    }
+    // something to play even if the very first iteration gets cut short
+    result.bestMove = _rootMoves[0];
+
+    int maxDepth = std::clamp(_limits.maxDepth, 1, maxSearchPly - 1);
+    // helper threads with an odd index start a ply deeper, so the threads don't all work on the same depth
+    int firstDepth = std::min(1 + (_threadIndex & 1), maxDepth);
+    for (int depth = firstDepth; depth <= maxDepth; depth++) {
+        // expect the score to stay close to the last one, a narrow window cuts off far more
+        int delta = aspirationWindow;
+        int alpha = -infiniteScore;
+        int beta = infiniteScore;
+        if (depth >= aspirationDepth) {
+            alpha = std::max(result.score - delta, -infiniteScore);
+            beta = std::min(result.score + delta, infiniteScore);
+        }
+        _rootBestMove = Move::none();
+        int score;
+        while (true) {
+            score = searchRoot(depth, alpha, beta);
+            if (_signals.stop.load(std::memory_order_relaxed)) {
+                break;
+            }
+            if (score <= alpha) {
+                // nothing reached the window, the best move is unknown until the search is repeated lower
+                beta = (alpha + beta) / 2;
+                alpha = std::max(score - delta, -infiniteScore);
+                _rootBestMove = Move::none();
+            } else if (score >= beta) {
+                beta = std::min(score + delta, infiniteScore);
+            } else {
+                break;
+            }
+            delta *= 2;
+        }
+        if (_signals.stop.load(std::memory_order_relaxed)) {
+            // the moves that finished were searched deeper, and the last best move always goes first
+            if (_rootBestMove) {
+                result.bestMove = _rootBestMove;
+            }
+            break;
+        }
+        result.bestMove = _rootBestMove;
+        result.score = score;
+        result.depth = depth;
+        if (_threadIndex == 0 && _limits.onIteration) {
+            result.nodes = totalNodes();
+            _limits.onIteration(result);
+        }
+
+        // no point going deeper once a mate is certain, or starting an iteration we can't finish
+        if (std::abs(score) >= mateInMaxPly) {
+            break;
+        }
+        if (_threadIndex == 0 && _limits.moveTimeMs > 0 && !_signals.pondering.load(std::memory_order_acquire) &&
+            elapsedMs() * 2 >= _limits.moveTimeMs) {
+            break;
+        }
+    }
+
+    // the table's move for the position after ours is the reply we expect
+    _position.makeMove(result.bestMove);
+    TTData reply;
+    if (_transpositionTable.probe(_position.key(), reply)) {
+        MoveList replies;
+        _position.generateMoves(replies);
+        if (replies.contains(reply.move)) {
+            result.ponderMove = reply.move;
+        }
+    }
+    _position.unmakeMove(result.bestMove);
+
+    result.nodes = _nodes;
+    return result;
+}
+
+// principal variation search at the root, _rootBestMove is only set by a move that got inside the window
+int Search::searchRoot(int depth, int alpha, int beta) {
+    int alphaOriginal = alpha;
+    int bestScore = -infiniteScore;
+    Move bestMove;
+    for (int i = 0; i < _rootMoves.size(); i++) {
+        Move move = _rootMoves[i];
+        _position.makeMove(move);
+        int score = searchChild(depth - 1, 1, alpha, beta, i == 0);
+        _position.unmakeMove(move);
+        if (aborted()) {
+            break;
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+        }
+        if (score > alpha) {
+            _rootBestMove = move;
+            // keep the best move at the front, the next iteration searches it first
+            std::rotate(_rootMoves.begin(), _rootMoves.begin() + i, _rootMoves.begin() + i + 1);
+            alpha = score;
+            if (alpha >= beta) {
+                break;
+            }
+        }
+    }
+    if (bestMove && !aborted()) {
+        TTBound bound = bestScore >= beta ? BoundLower : (bestScore > alphaOriginal ? BoundExact : BoundUpper);
+        _transpositionTable.store(_position.key(), bestMove, scoreToTT(bestScore, 0), depth, bound);
+    }
+    return bestScore;
+}
+
+// the first move gets the full window, the rest only have to prove they are no better,
+// and are searched again with the full window when one turns out to be.
+// a reduced move that beats alpha is searched again at full depth before that
+int Search::searchChild(int depth, int ply, int alpha, int beta, bool firstMove, int reduction) {
+    if (firstMove) {
+        return -negamax(depth, ply, -beta, -alpha);
+    }
+    int score;
+    if (reduction > 0) {
+        score = -negamax(depth - reduction, ply, -alpha - 1, -alpha);
+        if (score <= alpha || aborted()) {
+            return score;
+        }
+    }
+    score = -negamax(depth, ply, -alpha - 1, -alpha);
+    if (score > alpha && score < beta && !aborted()) {
+        score = -negamax(depth, ply, -beta, -alpha);
+    }
+    return score;
+}
+
+int Search::negamax(int depth, int ply, int alpha, int beta, bool allowNullMove) {
+    _nodes++;
+    checkLimits();
+    if (aborted()) {
+        return 0;
+    }
+    if (_position.isRepetition() || _position.halfmoveClock() >= 100) {
+        return 0;
+    }
+    if (depth <= 0) {
+        return quiescence(ply, alpha, beta);
+    }
+    if (ply >= maxSearchPly - 1) {
+        return evaluate();
+    }
+
+    // a deep enough stored result for this position may answer the whole node
+    int alphaOriginal = alpha;
+    TTData stored;
+    Move hashMove;
+    if (_transpositionTable.probe(_position.key(), stored)) {
+        hashMove = stored.move;
+        int score = scoreFromTT(stored.score, ply);
+        if (stored.depth >= depth &&
+            (stored.bound == BoundExact ||
+             (stored.bound == BoundLower && score >= beta) ||
+             (stored.bound == BoundUpper && score <= alpha))) {
+            return score;
+        }
+    }
+
+    // if passing the turn still keeps the score above beta, a real move surely would too.
+    // not when only pawns are left, that is where having to move can be the losing part
+    bool inCheck = _position.inCheck();
+    bool pvNode = beta - alpha > 1;
+    ChessColor us = _position.sideToMove();
+    Bitboard pieces = _position.pieces(us) & ~_position.pieces(us, Pawn) & ~_position.pieces(us, King);
+    if (allowNullMove && !pvNode && !inCheck && depth >= nullMoveDepth && pieces && evaluate() >= beta) {
+        int reduction = 2 + depth / 4;
+        _position.makeNullMove();
+        int score = -negamax(depth - 1 - reduction, ply + 1, -beta, -beta + 1, false);
+        _position.unmakeNullMove();
+        if (aborted()) {
+            return 0;
+        }
+        if (score >= beta) {
+            // a mate found after passing isn't a real one
+            return score >= mateInMaxPly ? beta : score;
+        }
+    }
+
+    MoveList moves;
+    _position.generateMoves(moves);
+    if (moves.empty()) {
+        // checkmate, or a stalemate which is worth nothing to either side
+        return inCheck ? -mateScore + ply : 0;
+    }
+
+    // the sooner the best move is tried the sooner the rest get cut off
+    int scores[maxMoves];
+    scoreMoves(moves, scores, hashMove, ply);
+
+    int bestScore = -infiniteScore;
+    Move bestMove;
+    for (int i = 0; i < moves.size(); i++) {
+        Move move = pickMove(moves, scores, i);
+        if (i == 1 && _pool && depth >= splitDepth && moves.size() > 2) {
+            // the eldest brother didn't cut off, so the younger ones all need searching and can go in parallel
+            for (int j = 2; j < moves.size(); j++) {
+                pickMove(moves, scores, j);
+            }
+            split(moves, 1, depth, ply, alpha, beta, inCheck, bestScore, bestMove);
+            if (aborted()) {
+                return 0;
+            }
+            if (bestScore >= beta && !_position.isCapture(bestMove) && bestMove.type() != PromotionMove) {
+                updateQuietStats(bestMove, depth, ply);
+            }
+            break;
+        }
+        int score = searchMove(move, i, depth, ply, alpha, beta, inCheck);
+        if (aborted()) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+        }
+        alpha = std::max(alpha, score);
+        if (alpha >= beta) {
+            if (!_position.isCapture(move) && move.type() != PromotionMove) {
+                updateQuietStats(move, depth, ply);
+            }
+            break;
+        }
+    }
+
+    TTBound bound = bestScore >= beta ? BoundLower : (bestScore > alphaOriginal ? BoundExact : BoundUpper);
+    _transpositionTable.store(_position.key(), bestMove, scoreToTT(bestScore, ply), depth, bound);
+    return bestScore;
+}
+
+int Search::searchMove(Move move, int moveIndex, int depth, int ply, int alpha, int beta, bool inCheck) {
+    bool quiet = !_position.isCapture(move) && move.type() != PromotionMove;
+    bool killer = move == _killers[ply][0] || move == _killers[ply][1];
+    _position.makeMove(move);
+    // quiet moves tried late are probably bad, look at them less deeply unless they give check
+    int reduction = 0;
+    if (depth >= reductionDepth && moveIndex >= reductionMoves && quiet && !killer && !inCheck && !_position.inCheck()) {
+        reduction = std::min(reductions[depth][moveIndex], depth - 2);
+    }
+    int score = searchChild(depth - 1, ply + 1, alpha, beta, moveIndex == 0, reduction);
+    _position.unmakeMove(move);
+    return score;
+}
+
+void Search::split(const MoveList &moves, int start, int depth, int ply, int &alpha, int beta, bool inCheck, int &bestScore, Move &bestMove) {
+    auto splitPoint = std::make_shared<SplitPoint>();
+    splitPoint->parent = _splitPoint;
+    splitPoint->position = _position;
+    splitPoint->moves = moves;
+    splitPoint->depth = depth;
+    splitPoint->ply = ply;
+    splitPoint->beta = beta;
+    splitPoint->inCheck = inCheck;
+    splitPoint->nextMove = start;
+    splitPoint->alpha = alpha;
+    splitPoint->cutoff = false;
+    splitPoint->bestScore = bestScore;
+    splitPoint->bestMove = bestMove;
+    _splits++;
+
+    // the pool's workers each search in their own Search, the one that belongs to them
+    int helpersWanted = moves.size() - start - 1;
+    _splitPoint = splitPoint.get();
+    _pool->runShared(helpersWanted, [splitPoint, this] {
+        _workers[ThreadPool::workerIndex() - 1]->helpSplitPoint(*splitPoint);
+    }, [&splitPoint, this] {
+        searchSplitMoves(*splitPoint);
+    });
+    _splitPoint = splitPoint->parent;
+
+    alpha = splitPoint->alpha;
+    bestScore = splitPoint->bestScore;
+    bestMove = splitPoint->bestMove;
+}
+
+int Search::searchSplitMoves(SplitPoint &splitPoint) {
+    int searched = 0;
+    while (!aborted()) {
+        int index = splitPoint.nextMove++;
+        if (index >= splitPoint.moves.size()) {
+            break;
+        }
+        Move move = splitPoint.moves[index];
+        int score = searchMove(move, index, splitPoint.depth, splitPoint.ply, splitPoint.alpha, splitPoint.beta, splitPoint.inCheck);
+        if (aborted()) {
+            break;
+        }
+        searched++;
+
+        std::lock_guard<std::mutex> lock(splitPoint.mutex);
+        if (score > splitPoint.bestScore) {
+            splitPoint.bestScore = score;
+            splitPoint.bestMove = move;
+        }
+        if (score > splitPoint.alpha) {
+            splitPoint.alpha = score;
+            if (score >= splitPoint.beta) {
+                splitPoint.cutoff = true;
+            }
+        }
+    }
+    return searched;
+}
+
+void Search::helpSplitPoint(SplitPoint &splitPoint) {
+    _position = splitPoint.position;
+    _splitPoint = &splitPoint;
+    _helpedMoves += searchSplitMoves(splitPoint);
+    _splitPoint = nullptr;
+}
+
+//
+// Only captures and queen promotions are searched past the horizon, so the score returned at a leaf
+// is never the middle of an exchange. The side to move may always stand pat on the static evaluation
+// unless it is in check, then every evasion is searched and a mate is a mate.
+//
+int Search::quiescence(int ply, int alpha, int beta) {
+    _nodes++;
+    checkLimits();
+    if (aborted()) {
+        return 0;
+    }
+    if (_position.halfmoveClock() >= 100) {
+        return 0;
+    }
+    if (ply >= maxSearchPly - 1) {
+        return evaluate();
+    }
+
+    bool inCheck = _position.inCheck();
+    int standPat = -infiniteScore;
+    MoveList moves;
+    if (inCheck) {
+        _position.generateMoves(moves);
+        if (moves.empty()) {
+            return -mateScore + ply;
+        }
+    } else {
+        standPat = evaluate();
+        if (standPat >= beta) {
+            return standPat;
+        }
+        // even winning a queen wouldn't get back to alpha
+        if (standPat + pieceScores[Queen] * 2 + deltaMargin < alpha) {
+            return standPat;
+        }
+        alpha = std::max(alpha, standPat);
+        _position.generateCaptures(moves);
+    }
+
+    int scores[maxMoves];
+    scoreMoves(moves, scores, Move::none(), ply);
+
+    int bestScore = standPat;
+    for (int i = 0; i < moves.size(); i++) {
+        Move move = pickMove(moves, scores, i);
+        if (!inCheck && move.type() != PromotionMove &&
+            standPat + pieceScores[_position.capturedPiece(move)] + deltaMargin <= alpha) {
+            continue;
+        }
+        _position.makeMove(move);
+        int score = -quiescence(ply + 1, -beta, -alpha);
+        _position.unmakeMove(move);
+        if (aborted()) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+        }
+        alpha = std::max(alpha, score);
+        if (alpha >= beta) {
+            break;
+        }
+    }
+    return bestScore;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "Position.h"
+#include "ThreadPool.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+struct SearchResult
+{
+    Move bestMove;
+    Move ponderMove; // the reply the search expects, none if it doesn't know
+    int score = 0;
+    int depth = 0; // deepest iteration that finished
+    uint64_t nodes = 0;
+};
+
+struct SearchLimits
+{
+    int maxDepth = maxSearchPly - 1;
+    int moveTimeMs = 0;    // 0 means no time limit
+    uint64_t maxNodes = 0; // 0 means no node limit
+    bool ponder = false;   // thinking on the opponent's time, the limits only start to count at Engine::ponderHit
+    // called by the main search after every iteration it finishes, on the search's thread
+    std::function<void(const SearchResult &)> onIteration;
+};
+
+// what the threads of one engine share, other threads may change it while they search
+struct SearchSignals
+{
+    std::atomic<bool> stop{false};
+    std::atomic<bool> pondering{false};
+    std::atomic<int64_t> clockStartMs{0}; // steady clock time the time limit counts from
+    std::atomic<uint64_t> nodes{0};       // nodes of every thread together, each adds its own in batches
+};
+
+// a node whose younger moves are being searched by more than one thread, lives in Search.cpp
+struct SplitPoint;
+
+//
+// Iterative deepening negamax over a Position, knows nothing about the GUI.
+// Each iteration searches one ply deeper than the last, starting with the best move it found,
+// until the depth limit is reached or the time budget runs out.
+// Every iteration after the first few starts in a narrow window around the previous score.
+// Engine runs one Search per thread over the same transposition table.
+// Given a thread pool, the search also splits: once the first move at a node deep enough has been
+// searched (the eldest brother), the pool's threads help with the rest (young brothers wait).
+//
+class Search
+{
+public:
+    // every search sharing signals ends together, threadIndex 0 is the main search and the others help it
+    Search(TranspositionTable &transpositionTable, SearchSignals &signals, int threadIndex = 0);
+
+    // the caller sets up the signals before starting, the search only ever raises stop
+    SearchResult think(const Position &position, const SearchLimits &limits);
+    // forget the move ordering statistics, for a new game
+    void clear();
+
+    void stop() { _signals.stop.store(true, std::memory_order_relaxed); }
+    static int64_t clockMs();
+
+    // workers[i] is the Search pool worker i + 1 runs its share of a split in, a null pool searches serially
+    void setSplitting(ThreadPool *pool, const std::vector<Search *> &workers);
+
+    // counters for measuring how well the threads share the work, resetStats zeroes them
+    uint64_t nodes() const { return _nodes; }
+    uint64_t splits() const { return _splits; }
+    uint64_t helpedMoves() const { return _helpedMoves; } // moves searched at other threads' split points
+    void resetStats();
+
+private:
+    int searchRoot(int depth, int alpha, int beta);
+    int negamax(int depth, int ply, int alpha, int beta, bool allowNullMove = true);
+    // searches the position after a move and returns its score for the side that made it
+    int searchChild(int depth, int ply, int alpha, int beta, bool firstMove, int reduction = 0);
+    // makes move, the moveIndex'th tried at this node, reduces it if it is late and quiet, and searches it
+    int searchMove(Move move, int moveIndex, int depth, int ply, int alpha, int beta, bool inCheck);
+    // searches moves from start on with the pool's help, keeping the best in bestScore and bestMove
+    void split(const MoveList &moves, int start, int depth, int ply, int &alpha, int beta, bool inCheck, int &bestScore, Move &bestMove);
+    // takes moves from the split point until there are none left or one of them cuts off, returns how many it searched
+    int searchSplitMoves(SplitPoint &splitPoint);
+    // what a pool worker runs for a split point it was asked to help
+    void helpSplitPoint(SplitPoint &splitPoint);
+    // stop was raised or a split point this search works under has already cut off
+    bool aborted() const;
+    // captures and queen promotions only, called where negamax runs out of depth
+    int quiescence(int ply, int alpha, int beta);
+    int evaluate();
+
+    // gives every move a sort key: hash move, captures by MVV-LVA, killers, then quiet moves by history
+    void scoreMoves(const MoveList &moves, int *scores, Move hashMove, int ply) const;
+    // swaps the best scored move left at or after index into index and returns it
+    Move pickMove(MoveList &moves, int *scores, int index) const;
+    // a quiet move caused a beta cutoff, remember it for the siblings of this node and for later
+    void updateQuietStats(Move move, int depth, int ply);
+
+    // every so often adds this thread's nodes to the shared count and raises stop once a limit is hit,
+    // never while pondering. only the main search keeps time
+    void checkLimits();
+    // the shared count plus what this thread hasn't added yet
+    uint64_t totalNodes() const;
+    // time since the clock started, which for a ponder search is the ponder hit
+    int elapsedMs() const;
+
+    TranspositionTable &_transpositionTable;
+    Position _position;
+    SearchLimits _limits;
+    SearchSignals &_signals;
+    int _threadIndex;
+    uint64_t _nodes;
+
+    ThreadPool *_pool;
+    std::vector<Search *> _workers;
+    const SplitPoint *_splitPoint; // the innermost split point the current search is under, if any
+    uint64_t _splits;
+    uint64_t _helpedMoves;
+
+    MoveList _rootMoves;
+    Move _rootBestMove;
+
+    PawnTable _pawnTable;
+
+    // two quiet moves per ply that recently cut off, newest first
+    Move _killers[maxSearchPly][2];
+    // butterfly table of cutoffs by quiet moves, indexed by side to move, from and to square
+    int _history[2][64][64];
+};
@@ -0,0 +1,144 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+static thread_local int currentWorker = 0;
+
+ThreadPool::ThreadPool(int workers) : _queued(0), _nextWorker(0), _quit(false) {
+    for (int i = 0; i < workers; i++) {
+        _workers.push_back(std::make_unique<Worker>());
+    }
+    // every queue exists before any worker starts looking at the others
+    for (int i = 0; i < workers; i++) {
+        _workers[i]->thread = std::thread(&ThreadPool::run, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _quit = true;
+    }
+    _wakeUp.notify_all();
+    for (auto &worker : _workers) {
+        worker->thread.join();
+    }
+}
+
+int ThreadPool::workerIndex() {
+    return currentWorker;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    // a worker keeps what it submits, anybody else hands it out round robin
+    int index = currentWorker > 0 ? currentWorker - 1 : (int)(_nextWorker++ % _workers.size());
+    {
+        std::lock_guard<std::mutex> lock(_workers[index]->mutex);
+        _workers[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _queued++;
+    }
+    _wakeUp.notify_one();
+}
+
+// what the caller of runShared and its helpers share, outlives the call for helpers that turn up late
+struct SharedRun
+{
+    std::function<void()> helperWork;
+    std::mutex mutex;
+    int helpers = 0;
+    bool closed = false; // no more helpers may join
+};
+
+void ThreadPool::runShared(int helpers, std::function<void()> helperWork, const std::function<void()> &ownWork) {
+    auto run = std::make_shared<SharedRun>();
+    run->helperWork = std::move(helperWork);
+    // helpers that arrive after the work ran out just leave again
+    for (int i = 0; i < std::min(helpers, workers()); i++) {
+        submit([run] {
+            {
+                std::lock_guard<std::mutex> lock(run->mutex);
+                if (run->closed) {
+                    return;
+                }
+                run->helpers++;
+            }
+            run->helperWork();
+            std::lock_guard<std::mutex> lock(run->mutex);
+            run->helpers--;
+        });
+    }
+    ownWork();
+
+    {
+        std::lock_guard<std::mutex> lock(run->mutex);
+        run->closed = true;
+    }
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(run->mutex);
+            if (run->helpers == 0) {
+                break;
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+bool ThreadPool::takeTask(int index, std::function<void()> &task) {
+    Worker &own = *_workers[index];
+    {
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (int i = 1; i < (int)_workers.size(); i++) {
+        Worker &victim = *_workers[(index + i) % _workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            own.steals++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(int index) {
+    currentWorker = index + 1;
+    while (true) {
+        std::function<void()> task;
+        if (takeTask(index, task)) {
+            _queued--;
+            _workers[index]->tasksRun++;
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _wakeUp.wait(lock, [this] { return _quit || _queued > 0; });
+        if (_quit) {
+            return;
+        }
+    }
+}
+
+std::vector<ThreadPool::WorkerStats> ThreadPool::stats() const {
+    std::vector<WorkerStats> result(_workers.size());
+    for (size_t i = 0; i < _workers.size(); i++) {
+        result[i].tasks = _workers[i]->tasksRun;
+        result[i].steals = _workers[i]->steals;
+    }
+    return result;
+}
+
+void ThreadPool::resetStats() {
+    for (auto &worker : _workers) {
+        worker->tasksRun = 0;
+        worker->steals = 0;
+    }
+}
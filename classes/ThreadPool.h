@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//
+// A fixed set of worker threads, each with its own queue of tasks.
+// A worker takes its newest task first and, when its queue runs dry, steals the oldest task from
+// another worker, the oldest tasks being the biggest pieces of work. Tasks submitted from outside
+// the pool are spread over the workers in turn.
+//
+class ThreadPool
+{
+public:
+    struct WorkerStats
+    {
+        uint64_t tasks = 0;  // tasks this worker ran
+        uint64_t steals = 0; // of those, how many came from another worker's queue
+    };
+
+    explicit ThreadPool(int workers);
+    ~ThreadPool();
+
+    void submit(std::function<void()> task);
+    // runs ownWork on the calling thread while up to helpers workers run helperWork alongside it, and returns once
+    // ownWork and every helper that started are done. a worker that only gets to its task after that skips it,
+    // so helperWork must hold on to whatever it uses
+    void runShared(int helpers, std::function<void()> helperWork, const std::function<void()> &ownWork);
+    int workers() const { return (int)_workers.size(); }
+    // 1 to workers() inside a worker of some pool, 0 on any other thread
+    static int workerIndex();
+
+    std::vector<WorkerStats> stats() const;
+    void resetStats();
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+        std::thread thread;
+        std::atomic<uint64_t> tasksRun{0};
+        std::atomic<uint64_t> steals{0};
+    };
+
+    void run(int index);
+    bool takeTask(int index, std::function<void()> &task);
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::mutex _sleepMutex;
+    std::condition_variable _wakeUp;
+    std::atomic<int> _queued;
+    std::atomic<unsigned> _nextWorker;
+    bool _quit;
+};
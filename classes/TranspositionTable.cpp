@@ -0,0 +1,108 @@
+#include "TranspositionTable.h"
+
+// data word layout
+//   bits 0-15  move
+//   bits 16-31 score (signed)
+//   bits 32-39 depth
+//   bits 40-41 bound
+//   bits 42-47 age
+// a zero data word means the entry was never written
+
+TranspositionTable::TranspositionTable() : _buckets(nullptr), _bucketCount(0), _megabytes(0), _age(0) {
+    resize(16);
+}
+
+TranspositionTable::~TranspositionTable() {
+    delete[] _buckets;
+}
+
+void TranspositionTable::resize(int megabytes) {
+    if (megabytes < 1) {
+        megabytes = 1;
+    }
+    if (megabytes == _megabytes && _buckets) {
+        return;
+    }
+    delete[] _buckets;
+    _megabytes = megabytes;
+    _bucketCount = ((uint64_t)megabytes * 1024 * 1024) / sizeof(Bucket);
+    _buckets = new Bucket[_bucketCount];
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (uint64_t i = 0; i < _bucketCount; i++) {
+        for (Entry &entry : _buckets[i].entries) {
+            entry.check.store(0, std::memory_order_relaxed);
+            entry.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    _age = 0;
+}
+
+uint64_t TranspositionTable::pack(Move move, int score, int depth, TTBound bound, int age) {
+    return (uint64_t)move.raw()
+         | ((uint64_t)(uint16_t)(int16_t)score << 16)
+         | ((uint64_t)(uint8_t)depth << 32)
+         | ((uint64_t)bound << 40)
+         | ((uint64_t)age << 42);
+}
+
+bool TranspositionTable::probe(uint64_t key, TTData &found) const {
+    Bucket &bucket = bucketFor(key);
+    for (const Entry &entry : bucket.entries) {
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        if (data && (entry.check.load(std::memory_order_relaxed) ^ data) == key) {
+            found.move = Move::fromRaw((uint16_t)data);
+            found.score = (int16_t)(uint16_t)(data >> 16);
+            found.depth = (int)(uint8_t)(data >> 32);
+            found.bound = (TTBound)((data >> 40) & 3);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, Move move, int score, int depth, TTBound bound) {
+    Bucket &bucket = bucketFor(key);
+    Entry *replace = nullptr;
+    int worstValue = 1 << 30;
+    for (Entry &entry : bucket.entries) {
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        if (!data || (entry.check.load(std::memory_order_relaxed) ^ data) == key) {
+            // same position (or an empty slot), keep the old move if we don't have one
+            if (data && move.isNone()) {
+                move = Move::fromRaw((uint16_t)data);
+            }
+            replace = &entry;
+            break;
+        }
+        // prefer to throw out shallow entries left over from earlier searches
+        int entryAge = (int)((data >> 42) & 63);
+        int value = (int)(uint8_t)(data >> 32) - 8 * ((_age - entryAge) & 63);
+        if (value < worstValue) {
+            worstValue = value;
+            replace = &entry;
+        }
+    }
+    if (depth < 0) {
+        depth = 0;
+    }
+    uint64_t data = pack(move, score, depth, bound, _age);
+    replace->data.store(data, std::memory_order_relaxed);
+    replace->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    int used = 0;
+    uint64_t samples = _bucketCount < 250 ? _bucketCount : 250;
+    for (uint64_t i = 0; i < samples; i++) {
+        for (const Entry &entry : _buckets[i].entries) {
+            uint64_t data = entry.data.load(std::memory_order_relaxed);
+            if (data && (int)((data >> 42) & 63) == _age) {
+                used++;
+            }
+        }
+    }
+    return samples ? (int)(used * 1000 / (samples * 4)) : 0;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Move.h"
+#include "Position.h"
+#include <atomic>
+#include <cstdint>
+
+enum TTBound {
+    BoundNone,
+    BoundUpper, // the score is at most this (no move got above alpha)
+    BoundLower, // the score is at least this (beta cutoff)
+    BoundExact
+};
+
+// a mate found n plies from the root scores mateScore - n
+const int mateScore = 30000;
+const int mateInMaxPly = mateScore - maxSearchPly;
+
+// mate scores are stored relative to the node instead of the root, so they stay right wherever the position turns up again
+inline int scoreToTT(int score, int ply)
+{
+    return score >= mateInMaxPly ? score + ply : score <= -mateInMaxPly ? score - ply : score;
+}
+inline int scoreFromTT(int score, int ply)
+{
+    return score >= mateInMaxPly ? score - ply : score <= -mateInMaxPly ? score + ply : score;
+}
+
+// what a probe hands back, scores are exactly as they were stored
+struct TTData
+{
+    Move move;
+    int score;
+    int depth;
+    TTBound bound;
+};
+
+//
+// Transposition table shared by every search thread without locks.
+// An entry is two 64-bit words, the packed data and the key xor'ed with that data,
+// so a probe only trusts an entry when both words were written by the same store.
+// Four entries make a 64 byte bucket that sits on one cache line.
+//
+class TranspositionTable
+{
+public:
+    TranspositionTable();
+    ~TranspositionTable();
+
+    // reallocates (and clears) the table if the size changed
+    void resize(int megabytes);
+    void clear();
+    int sizeMB() const { return _megabytes; }
+
+    // call once per move searched so entries from older searches get replaced first
+    void newSearch() { _age = (_age + 1) & 63; }
+
+    bool probe(uint64_t key, TTData &data) const;
+    void store(uint64_t key, Move move, int score, int depth, TTBound bound);
+
+    // permille of entries written by the current search, sampled from the first buckets
+    int hashfull() const;
+
+private:
+    struct Entry
+    {
+        std::atomic<uint64_t> check; // key ^ data
+        std::atomic<uint64_t> data;
+    };
+
+    struct alignas(64) Bucket
+    {
+        Entry entries[4];
+    };
+
+    static uint64_t pack(Move move, int score, int depth, TTBound bound, int age);
+
+    Bucket &bucketFor(uint64_t key) const
+    {
+        // maps the key onto [0, _bucketCount) without needing a power of two count
+        return _buckets[((key >> 32) * _bucketCount) >> 32];
+    }
+
+    Bucket *_buckets;
+    uint64_t _bucketCount;
+    int _megabytes;
+    int _age;
+};
@@ -0,0 +1,248 @@
+#include "UCI.h"
+#include "Benchmark.h"
+#include "Perft.h"
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+
+// how many more moves to plan for when the gui doesn't say
+static const int defaultMovesToGo = 30;
+// kept in hand for the time it takes to get the move back to the gui
+static const int moveOverheadMs = 50;
+
+UCI::UCI(std::istream &input, std::ostream &output) : _input(input), _output(output) {
+    _position.setFromFEN(startPositionFEN);
+}
+
+UCI::~UCI() {
+    stopSearch();
+}
+
+void UCI::send(const std::string &text) {
+    std::lock_guard<std::mutex> lock(_outputMutex);
+    _output << text << std::endl;
+}
+
+void UCI::loop() {
+    std::string line;
+    while (std::getline(_input, line)) {
+        if (line == "quit") {
+            break;
+        }
+        handleCommand(line);
+    }
+    stopSearch();
+}
+
+void UCI::handleCommand(const std::string &line) {
+    std::istringstream arguments(line);
+    std::string command;
+    arguments >> command;
+
+    if (command == "uci") {
+        uci();
+    } else if (command == "isready") {
+        send("readyok");
+    } else if (command == "ucinewgame") {
+        stopSearch();
+        _engine.clear();
+        _position.setFromFEN(startPositionFEN);
+    } else if (command == "setoption") {
+        setOption(arguments);
+    } else if (command == "position") {
+        stopSearch();
+        setPosition(arguments);
+    } else if (command == "go") {
+        go(arguments);
+    } else if (command == "stop") {
+        stopSearch();
+    } else if (command == "bench") {
+        stopSearch();
+        bench(arguments);
+    } else if (command == "ponderhit") {
+        _engine.ponderHit();
+    } else if (!command.empty()) {
+        send("info string unknown command " + command);
+    }
+}
+
+void UCI::uci() {
+    send("id name Chess-AI");
+    send("id author Chess-AI developers");
+    send("option name Hash type spin default 16 min 1 max 4096");
+    send("option name Threads type spin default 1 min 1 max 256");
+    send("uciok");
+}
+
+// setoption name <id> value <x>
+void UCI::setOption(std::istringstream &arguments) {
+    std::string token, name, value;
+    arguments >> token; // name
+    while (arguments >> token && token != "value") {
+        name += (name.empty() ? "" : " ") + token;
+    }
+    arguments >> value;
+
+    stopSearch();
+    if (name == "Hash") {
+        _engine.setHashSizeMB(std::clamp(std::atoi(value.c_str()), 1, 4096));
+    } else if (name == "Threads") {
+        _engine.setThreads(std::clamp(std::atoi(value.c_str()), 1, 256));
+    } else {
+        send("info string unknown option " + name);
+    }
+}
+
+// position [fen <fen> | startpos] [moves <move> ...]
+void UCI::setPosition(std::istringstream &arguments) {
+    std::string token, fen;
+    arguments >> token;
+    if (token == "startpos") {
+        fen = startPositionFEN;
+        arguments >> token; // moves
+    } else if (token == "fen") {
+        while (arguments >> token && token != "moves") {
+            fen += token + " ";
+        }
+    } else {
+        return;
+    }
+    if (!_position.setFromFEN(fen)) {
+        send("info string bad fen " + fen);
+        _position.setFromFEN(startPositionFEN);
+        return;
+    }
+
+    while (arguments >> token) {
+        MoveList moves;
+        _position.generateMoves(moves);
+        const Move *match = std::find_if(moves.begin(), moves.end(), [&token](Move move) { return move.notation() == token; });
+        if (match == moves.end()) {
+            send("info string illegal move " + token);
+            return;
+        }
+        if (_position.historyLength() >= maxGamePlies) {
+            _position.clearHistory();
+        }
+        _position.makeMove(*match);
+    }
+}
+
+// go [depth n] [movetime ms] [wtime ms] [btime ms] [winc ms] [binc ms] [movestogo n] [nodes n] [infinite] [ponder]
+// go perft <depth>
+void UCI::go(std::istringstream &arguments) {
+    stopSearch();
+
+    SearchLimits limits;
+    int time[2] = { 0, 0 };
+    int increment[2] = { 0, 0 };
+    int movesToGo = 0;
+    std::string token;
+    while (arguments >> token) {
+        if (token == "perft") {
+            int depth = 1;
+            arguments >> depth;
+            perft(std::max(1, depth));
+            return;
+        } else if (token == "depth") {
+            arguments >> limits.maxDepth;
+        } else if (token == "movetime") {
+            arguments >> limits.moveTimeMs;
+        } else if (token == "wtime") {
+            arguments >> time[White];
+        } else if (token == "btime") {
+            arguments >> time[Black];
+        } else if (token == "winc") {
+            arguments >> increment[White];
+        } else if (token == "binc") {
+            arguments >> increment[Black];
+        } else if (token == "movestogo") {
+            arguments >> movesToGo;
+        } else if (token == "nodes") {
+            arguments >> limits.maxNodes;
+        } else if (token == "infinite" || token == "ponder") {
+            // no limit counts and the answer waits for stop, or for ponderhit to start the clock
+            limits.ponder = true;
+        }
+    }
+
+    // spread what is left over the moves still to play, the increment comes back every move
+    ChessColor us = _position.sideToMove();
+    if (time[us] > 0 && limits.moveTimeMs == 0) {
+        int budget = time[us] / (movesToGo > 0 ? movesToGo : defaultMovesToGo) + increment[us] * 3 / 4;
+        limits.moveTimeMs = std::max(1, std::min(budget, time[us] - moveOverheadMs));
+    }
+
+    int64_t startMs = Search::clockMs();
+    limits.onIteration = [this, startMs](const SearchResult &result) {
+        int64_t elapsedMs = Search::clockMs() - startMs;
+        std::ostringstream info;
+        info << "info depth " << result.depth << " score ";
+        if (std::abs(result.score) >= mateInMaxPly) {
+            // plies to mate, turned into moves
+            int plies = mateScore - std::abs(result.score);
+            info << "mate " << (result.score > 0 ? (plies + 1) / 2 : -plies / 2);
+        } else {
+            info << "cp " << result.score;
+        }
+        info << " nodes " << result.nodes << " time " << elapsedMs << " nps " << result.nodes * 1000 / std::max<int64_t>(elapsedMs, 1)
+             << " hashfull " << _engine.hashfull() << " pv " << result.bestMove.notation();
+        send(info.str());
+    };
+
+    std::future<SearchResult> search = _engine.startThinking(_position, limits);
+    _waiter = std::thread([this, search = std::move(search)]() mutable {
+        SearchResult result = search.get();
+        std::string text = "bestmove " + result.bestMove.notation();
+        if (result.ponderMove) {
+            text += " ponder " + result.ponderMove.notation();
+        }
+        send(text);
+    });
+}
+
+void UCI::perft(int depth) {
+    int64_t startMs = Search::clockMs();
+    uint64_t nodes = 0;
+    // counts on as many threads as the search would use
+    std::unique_ptr<ThreadPool> pool;
+    if (_engine.threads() > 1) {
+        pool = std::make_unique<ThreadPool>(_engine.threads() - 1);
+    }
+    for (const PerftDivide &root : Perft::divide(_position, depth, nullptr, pool.get(), true)) {
+        send(root.move.notation() + ": " + std::to_string(root.nodes));
+        nodes += root.nodes;
+    }
+    int64_t elapsedMs = std::max<int64_t>(Search::clockMs() - startMs, 1);
+    send("");
+    send("Nodes searched: " + std::to_string(nodes));
+    send("info string time " + std::to_string(elapsedMs) + " ms nps " + std::to_string(nodes * 1000 / elapsedMs));
+}
+
+void UCI::bench(std::istringstream &arguments) {
+    int depth = 10, threads = 1, hashMB = 16;
+    arguments >> depth >> threads >> hashMB;
+
+    // the game's engine keeps its table and settings
+    Engine engine;
+    engine.setThreads(std::clamp(threads, 1, 256));
+    engine.setHashSizeMB(std::clamp(hashMB, 1, 4096));
+    engine.setSearchMode(_engine.searchMode());
+    BenchmarkResult total = Benchmark::run(engine, std::max(1, depth), [this](int index, const SearchResult &result) {
+        send("info string position " + std::to_string(index + 1) + "/" + std::to_string(Benchmark::positionCount) + " bestmove " +
+             result.bestMove.notation() + " nodes " + std::to_string(result.nodes));
+    });
+    int64_t elapsedMs = std::max<int64_t>(total.elapsedMs, 1);
+    send("");
+    send("Total time (ms) : " + std::to_string(elapsedMs));
+    send("Nodes searched  : " + std::to_string(total.nodes));
+    send("Nodes/second    : " + std::to_string(total.nodes * 1000 / elapsedMs));
+}
+
+void UCI::stopSearch() {
+    if (_waiter.joinable()) {
+        _engine.stop();
+        _waiter.join();
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Engine.h"
+#include "Position.h"
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+//
+// Universal Chess Interface front end, lets match and analysis tools drive the engine over stdin and stdout.
+// Commands are read on the loop's own thread while the search runs on the engine's worker,
+// so stop and quit are handled as soon as they arrive. A waiter thread prints bestmove when the search ends.
+//
+class UCI
+{
+public:
+    UCI(std::istream &input, std::ostream &output);
+    ~UCI();
+
+    // reads commands until quit or the end of input
+    void loop();
+
+private:
+    void handleCommand(const std::string &line);
+    void uci();
+    void setOption(std::istringstream &arguments);
+    void setPosition(std::istringstream &arguments);
+    void go(std::istringstream &arguments);
+    // go perft <depth>, prints the leaf count per root move of the current position
+    void perft(int depth);
+    // bench [depth] [threads] [hash], searches the built-in positions on an engine of its own and reports the node count
+    void bench(std::istringstream &arguments);
+    // stops a running search and waits until its bestmove has been printed
+    void stopSearch();
+    void send(const std::string &text);
+
+    std::istream &_input;
+    std::ostream &_output;
+    std::mutex _outputMutex;
+    Engine _engine;
+    Position _position;
+    std::thread _waiter; // prints the bestmove of the running search
+};
@@ -0,0 +1,51 @@
+#include "Zobrist.h"
+#include <mutex>
+
+uint64_t Zobrist::pieceSquare[2][7][64];
+uint64_t Zobrist::castling[16];
+uint64_t Zobrist::enPassantFile[8];
+uint64_t Zobrist::blackToMove;
+
+static void fillTables()
+{
+    // xorshift64*, fixed seed so keys are the same from run to run
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    auto next = [&state]() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    };
+
+    for (int color = 0; color < 2; color++) {
+        for (int piece = 0; piece < 7; piece++) {
+            for (int square = 0; square < 64; square++) {
+                // slot 0 is "no piece" and never changes the key
+                Zobrist::pieceSquare[color][piece][square] = piece == 0 ? 0 : next();
+            }
+        }
+    }
+    // each right gets its own number and a set of rights is the xor of them
+    uint64_t rights[4];
+    for (int i = 0; i < 4; i++) {
+        rights[i] = next();
+    }
+    for (int mask = 0; mask < 16; mask++) {
+        Zobrist::castling[mask] = 0;
+        for (int i = 0; i < 4; i++) {
+            if (mask & (1 << i)) {
+                Zobrist::castling[mask] ^= rights[i];
+            }
+        }
+    }
+    for (int file = 0; file < 8; file++) {
+        Zobrist::enPassantFile[file] = next();
+    }
+    Zobrist::blackToMove = next();
+}
+
+void Zobrist::init()
+{
+    static std::once_flag once;
+    std::call_once(once, fillTables);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+//
+// random numbers for Zobrist hashing: a position's key is the xor of the numbers for
+// everything on it, so making a move only has to xor out what changed and xor in what's new
+//
+namespace Zobrist {
+    // fills the tables, safe to call more than once
+    void init();
+
+    extern uint64_t pieceSquare[2][7][64];
+    extern uint64_t castling[16];
+    extern uint64_t enPassantFile[8];
+    extern uint64_t blackToMove;
+}
@@ -0,0 +1,173 @@
+// Console tool that runs fixed workloads on the engine and times them, no window or OpenGL involved.
+//
+//   chess-bench search [depth]                                  times the table setup, then searches the start position to depth (default 10)
+//   chess-bench perft <depth> [divide] [hash <MB>] [threads <n>] [ply2] [fen <fen>]
+//                                          counts the leaves of the move tree, per root move with divide. with more than one
+//                                          thread the root moves, or with ply2 their replies, are shared out
+//   chess-bench bench [depth] [threads <n>] [hash <MB>] [mode serial|lazysmp|ybw]
+//                                          searches the built-in positions to depth (default 10), the node count is the
+//                                          engine's signature and is only repeatable with one thread
+//   chess-bench material <fen>             says whether the material on the board counts as a dead draw
+
+#include "classes/Benchmark.h"
+#include "classes/Engine.h"
+#include "classes/Perft.h"
+#include "classes/Position.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+static int search(int argc, char** argv)
+{
+    // building the attack, key and material tables happens the first time a Position is made
+    int64_t startMs = Search::clockMs();
+    Position position;
+    int64_t setupMs = Search::clockMs() - startMs;
+    printf("table setup: %lld ms\n", (long long)setupMs);
+
+    SearchLimits limits;
+    limits.maxDepth = argc > 0 ? std::max(1, atoi(argv[0])) : 10;
+    position.setFromFEN(startPositionFEN);
+
+    Engine engine;
+    startMs = Search::clockMs();
+    SearchResult result = engine.think(position, limits);
+    int64_t searchMs = std::max<int64_t>(Search::clockMs() - startMs, 1);
+    printf("depth %d bestmove %s score %d nodes %llu time %lld ms nps %llu\n", result.depth, result.bestMove.notation().c_str(), result.score,
+           (unsigned long long)result.nodes, (long long)searchMs, (unsigned long long)(result.nodes * 1000 / searchMs));
+    return 0;
+}
+
+static int perft(int argc, char** argv)
+{
+    if (argc < 1) {
+        fprintf(stderr, "perft needs a depth\n");
+        return 1;
+    }
+    int depth = std::max(1, atoi(argv[0]));
+    bool divide = false;
+    int hashMB = 0;
+    int threads = 1;
+    bool splitReplies = false;
+    std::string fen = startPositionFEN;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "divide") {
+            divide = true;
+        } else if (argument == "hash" && i + 1 < argc) {
+            hashMB = atoi(argv[++i]);
+        } else if (argument == "threads" && i + 1 < argc) {
+            threads = std::max(1, atoi(argv[++i]));
+        } else if (argument == "ply2") {
+            splitReplies = true;
+        } else if (argument == "fen") {
+            // the rest of the line, whether it was quoted or not
+            fen.clear();
+            while (++i < argc) {
+                fen += std::string(argv[i]) + " ";
+            }
+        }
+    }
+
+    Position position;
+    if (!position.setFromFEN(fen)) {
+        fprintf(stderr, "bad fen %s\n", fen.c_str());
+        return 1;
+    }
+    std::unique_ptr<PerftTable> table;
+    if (hashMB > 0) {
+        table = std::make_unique<PerftTable>(hashMB);
+    }
+    // the calling thread counts too, so the pool only needs the others
+    std::unique_ptr<ThreadPool> pool;
+    if (threads > 1) {
+        pool = std::make_unique<ThreadPool>(threads - 1);
+    }
+
+    int64_t startMs = Search::clockMs();
+    uint64_t nodes = 0;
+    if (divide) {
+        for (const PerftDivide &root : Perft::divide(position, depth, table.get(), pool.get(), splitReplies)) {
+            printf("%s: %llu\n", root.move.notation().c_str(), (unsigned long long)root.nodes);
+            nodes += root.nodes;
+        }
+    } else {
+        nodes = Perft::count(position, depth, table.get(), pool.get(), splitReplies);
+    }
+    int64_t elapsedMs = std::max<int64_t>(Search::clockMs() - startMs, 1);
+    printf("depth %d nodes %llu time %lld ms nps %llu\n", depth, (unsigned long long)nodes, (long long)elapsedMs,
+           (unsigned long long)(nodes * 1000 / elapsedMs));
+    return 0;
+}
+
+static int bench(int argc, char** argv)
+{
+    int depth = 10;
+    int threads = 1;
+    int hashMB = 16;
+    SearchMode mode = LazySMPSearch;
+    for (int i = 0; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "threads" && i + 1 < argc) {
+            threads = std::max(1, atoi(argv[++i]));
+        } else if (argument == "hash" && i + 1 < argc) {
+            hashMB = std::max(1, atoi(argv[++i]));
+        } else if (argument == "mode" && i + 1 < argc) {
+            std::string name = argv[++i];
+            mode = name == "serial" ? SerialSearch : name == "ybw" ? YoungBrothersSearch : LazySMPSearch;
+        } else {
+            depth = std::max(1, atoi(argv[i]));
+        }
+    }
+
+    Engine engine;
+    engine.setThreads(threads);
+    engine.setHashSizeMB(hashMB);
+    engine.setSearchMode(mode);
+    BenchmarkResult total = Benchmark::run(engine, depth, [](int index, const SearchResult &result) {
+        printf("position %2d/%d bestmove %s score %d nodes %llu\n", index + 1, Benchmark::positionCount, result.bestMove.notation().c_str(),
+               result.score, (unsigned long long)result.nodes);
+    });
+    int64_t elapsedMs = std::max<int64_t>(total.elapsedMs, 1);
+    printf("\ntotal time (ms) : %lld\nnodes searched  : %llu\nnodes/second    : %llu\n", (long long)elapsedMs,
+           (unsigned long long)total.nodes, (unsigned long long)(total.nodes * 1000 / elapsedMs));
+    return 0;
+}
+
+static int material(int argc, char** argv)
+{
+    std::string fen;
+    for (int i = 0; i < argc; i++) {
+        fen += std::string(argv[i]) + " ";
+    }
+    Position position;
+    if (!position.setFromFEN(fen)) {
+        fprintf(stderr, "bad fen %s\n", fen.c_str());
+        return 1;
+    }
+    printf("insufficient material: %s\n", Material::probe(position.materialKey()).insufficient ? "yes" : "no");
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    std::string command = argc > 1 ? argv[1] : "search";
+    if (command == "search") {
+        return search(argc - 2, argv + 2);
+    }
+    if (command == "perft") {
+        return perft(argc - 2, argv + 2);
+    }
+    if (command == "bench") {
+        return bench(argc - 2, argv + 2);
+    }
+    if (command == "material") {
+        return material(argc - 2, argv + 2);
+    }
+    fprintf(stderr, "usage: chess-bench search [depth] | perft <depth> [divide] [hash <MB>] [threads <n>] [ply2] [fen <fen>]\n"
+                    "       chess-bench bench [depth] [threads <n>] [hash <MB>] [mode serial|lazysmp|ybw]\n"
+                    "       chess-bench material <fen>\n");
+    return 1;
+}
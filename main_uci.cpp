@@ -0,0 +1,12 @@
+// Console entry point for the engine, speaks UCI on stdin and stdout, no window or OpenGL involved.
+
+#include "classes/UCI.h"
+#include <iostream>
+
+int main(int, char**)
+{
+    std::ios::sync_with_stdio(false);
+    UCI uci(std::cin, std::cout);
+    uci.loop();
+    return 0;
+}